@@ -1,12 +1,13 @@
 //------------------------------------------------------------------------------
 // main.c
 //
-// A card game loosely inspired by Ohanami in which two players compete to score
-// the most points by creating rows of cards. The game is played in two phases:
-// In the first phase, players choose two cards from their hand cards and add
-// them to their chosen cards. In the second phase, players choose a chosen card
-// and add it to a row. The game ends when both players have no hand cards and
-// no chosen cards left. The player with the most points wins the game.
+// A card game loosely inspired by Ohanami in which two or more players compete
+// to score the most points by creating rows of cards. The game is played in two
+// phases: In the first phase, players choose two cards from their hand cards
+// and add them to their chosen cards. In the second phase, players choose a
+// chosen card and add it to a row. The game ends when a player has no hand
+// cards and no chosen cards left. The player with the most points wins the
+// game.
 //
 // Group: Matthias_Bergman
 //
@@ -14,10 +15,35 @@
 //------------------------------------------------------------------------------
 //
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <dlfcn.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "a3_strategy.h"
 
 #define WRONG_ARGUMENT_COUNT 1
 #define WRONG_ARGUMENT_COUNT_MESSAGE "Usage: ./a3 <config file>\n"
@@ -36,21 +62,144 @@
 #define WRONG_CHOSENCARDS_NUMBER "Please enter the number of a card in your chosen cards!\n"
 #define CARD_CANNOT_EXTEND_ROW "This card cannot extend the chosen row!\n"
 #define WARNING_FILE_NOT_WRITTEN "Warning: Results not written to file!\n"
-#define PlAYER_1_WINS "Congratulations! Player 1 wins the game!\n"
-#define PlAYER_2_WINS "Congratulations! Player 2 wins the game!\n"
+#define PLAYERS_NOT_SUPPORTED "Error: This mode supports %i players only: %s\n"
+#define PLAYER_WINS "Congratulations! Player %i wins the game!\n"
 #define PROMPT_CHOOSE_FIRST_CARD "Please choose a first card to keep:\n"
 #define PROMPT_CHOOSE_SECOND_CARD "Please choose a second card to keep:\n"
 #define CHOOSING_PHASE_IS_OVER "Card choosing phase is over - passing remaining hand cards to the next player!\n"
 #define ACTION_PHASE_IS_OVER "Action phase is over - starting next game round!\n"
 #define PROMPT_PLAYER_ACTION "What do you want to do?\n"
+#define WELCOME_MESSAGE "Welcome to SyntaxSakura (%i players are playing)!\n"
+#define CARD_CHOOSING_PHASE_TITLE "-------------------\nCARD CHOOSING PHASE\n-------------------\n"
+#define ACTION_PHASE_TITLE "------------\nACTION PHASE\n------------\n"
+#define CONFIG_MAGIC_NUMBER "ESP"
+#define CONFIG_READ_BLOCK_SIZE 4096
+#define CONFIG_SEED_PREFIX "SEED "
+#define MAX_CARD_VALUE 120
+#define CARDS_TO_KEEP 2
+#define SIMULATION_CHUNK_SIZE 256
+#define MAX_SIMULATION_THREADS 256
+#define SIMULATE_OPTION "--simulate"
+#define STRATEGY_OPTION "--strategy"
+#define MAX_STRATEGY_OPTIONS 16
+#define PLUGIN_OPTION "--plugin"
+#define MAX_STRATEGY_PLUGINS 8
+#define QUIET_OPTION "--quiet"
+#define BOT_OPTION "--bot"
+#define BOT_TIME_OPTION "--bot-time"
+#define DEFAULT_SEARCH_TIME_MS 80
+#define MAX_SEARCH_TIME_MS 60000
+#define MAX_SEARCH_THREADS 16
+#define MAX_SEARCH_MOVES 64
+#define SEARCH_EXPLORATION 1.4
+#define SEARCH_CLOCK_INTERVAL 16
+#define SOLVE_OPTION "--solve"
+#define MAX_SOLVER_MOVES 64
+#define MAX_SOLVER_LINE 64
+#define SOLVER_TABLE_BITS 22
+#define MAX_SOLVER_CARDS 32
+#define LOG_OPTION "--log"
+#define REPLAY_OPTION "--replay"
+#define WARNING_LOG_NOT_WRITTEN "Warning: Event log not written!\n"
+#define EVENT_LOG_MAGIC "A3EL"
+#define EVENT_LOG_VERSION 1
+#define EVENT_LOG_HEADER_SIZE 24
+#define EVENT_SIZE 8
+#define MAX_GAME_EVENTS 64
+#define EVENT_LOG_READ_BUFFER_SIZE (1 << 20)
+#define SAVE_OPTION "--save"
+#define LOAD_OPTION "--load"
+#define WARNING_GAME_NOT_SAVED "Warning: Game not saved!\n"
+#define SNAPSHOT_MAGIC "A3SS"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_HEADER_SIZE 22
+#define SNAPSHOT_CARD_SIZE 3
+#define MAX_SNAPSHOT_CARDS 32
+#define SNAPSHOT_SIZE (SNAPSHOT_HEADER_SIZE + MAX_SNAPSHOT_CARDS * SNAPSHOT_CARD_SIZE)
+#define SNAPSHOT_LISTS_COUNT (2 + MAX_CARD_ROWS)
+#define SERVE_OPTION "--serve"
+#define SERVER_BACKLOG 512
+#define MAX_SERVER_EVENTS 256
+#define SESSION_INPUT_SIZE 1024
+#define MAX_SESSION_OUTPUT 65536
+#define MAX_SERVER_PORT 65535
+#define JOURNAL_OPTION "--journal"
+#define JOURNAL_SYNC_OPTION "--journal-sync"
+#define JOURNAL_SUMMARY_OPTION "--journal-summary"
+#define WARNING_JOURNAL_NOT_WRITTEN "Warning: Results journal not written!\n"
+#define JOURNAL_MAGIC "A3RJ"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 8
+#define JOURNAL_RECORD_SIZE 40
+#define JOURNAL_BATCH_RECORDS 512
+#define JOURNAL_READ_RECORDS 4096
+#define DEFAULT_JOURNAL_SYNC_MS 1000
+#define MAX_JOURNAL_SYNC_MS 3600000
+#define STATS_OPTION "--stats"
+#define WARNING_STATS_NOT_COMPILED "Warning: Statistics are not compiled in, build with -DA3_STATS!\n"
+#define INVALID_COMMAND_TYPES 6
+#define TOURNAMENT_OPTION "--tournament"
+#define TOURNAMENT_GAMES_OPTION "--tournament-games"
+#define TOURNAMENT_CHUNK_SIZE 16
+#define BOOK_OPTION "--book"
+#define BUILD_BOOK_OPTION "--build-book"
+#define BOOK_GAMES_OPTION "--book-games"
+#define DEFAULT_BOOK_GAMES 100
+#define MAX_BOOK_GAMES 1000000
+#define OPENING_BOOK_MAGIC "A3OB"
+#define OPENING_BOOK_VERSION 1
+#define OPENING_BOOK_HEADER_SIZE 16
+#define OPENING_BOOK_ENTRY_SIZE 16
+#define OPENING_BOOK_MIN_CAPACITY 16
+#define OPENING_BOOK_HAND_ENTRIES 3
+#define MAX_TOURNAMENT_GAMES 1000000000L
+#define OUTPUT_BUFFER_INITIAL_CAPACITY 1024
+#define OUTPUT_FORMAT_SIZE 256
+#define INPUT_READ_BLOCK_SIZE 4096
+#define END_OF_INPUT 5
 
 const int CONFIG_CARDS_LINE_START = 3;
-const int CONFIG_CARDS_LINE_END = 23;
-const int MAX_CARD_ROWS = 3;
+#define HAND_SIZE 10
+#define MIN_PLAYERS 2
+#define MAX_PLAYERS 64
+#define DECK_SIZE (MIN_PLAYERS * HAND_SIZE)
+#define MAX_DECK_SIZE (MAX_PLAYERS * HAND_SIZE)
+#define CARD_SET_SIZE 128
+#define CARD_SET_WORDS (CARD_SET_SIZE / 64)
+#define MAX_CARD_ROWS 3
+#define MAX_COMMAND_ARGUMENTS 2
+#define COLOR_TABLE_SIZE 256
 const char* PLACE_ACTION = "place";
 const char* DISCARD_ACTION = "discard";
 const char* QUIT_ACTION = "quit";
 const char* HELP_ACTION = "help";
+const char* HINT_ACTION = "hint";
+const char* HELP_MESSAGE = "\n"
+                           "Available commands:\n"
+                           "\n"
+                           "- help\n"
+                           "  Display this help message.\n"
+                           "\n"
+                           "- place <row number> <card number>\n"
+                           "  Append a card to the chosen row or if the chosen row does not exist create it.\n"
+                           "\n"
+                           "- discard <card number>\n"
+                           "  Discard a card from the chosen cards.\n"
+                           "\n"
+                           "- quit\n"
+                           "  Terminate the program.\n"
+                           "\n";
+
+// The printed values of all cards that fit into a CardSet, so that status output needs no number formatting
+const char *const CARD_VALUE_LABELS[CARD_SET_SIZE] = {
+  "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15", "16", "17", "18", "19", "20",
+  "21", "22", "23", "24", "25", "26", "27", "28", "29", "30", "31", "32", "33", "34", "35", "36", "37", "38", "39",
+  "40", "41", "42", "43", "44", "45", "46", "47", "48", "49", "50", "51", "52", "53", "54", "55", "56", "57", "58",
+  "59", "60", "61", "62", "63", "64", "65", "66", "67", "68", "69", "70", "71", "72", "73", "74", "75", "76", "77",
+  "78", "79", "80", "81", "82", "83", "84", "85", "86", "87", "88", "89", "90", "91", "92", "93", "94", "95", "96",
+  "97", "98", "99", "100", "101", "102", "103", "104", "105", "106", "107", "108", "109", "110", "111", "112", "113",
+  "114", "115", "116", "117", "118", "119", "120", "121", "122", "123", "124", "125", "126", "127"
+};
 
 enum _Color_
 {
@@ -61,6 +210,35 @@ enum _Color_
 };
 typedef enum _Color_ Color;
 
+// The points a card is worth at the end of the game, indexed by the character of its color. Any other character is
+// not a color and is worth nothing.
+const int CARD_COLOR_POINTS[COLOR_TABLE_SIZE] = {[RED] = 10, [WHITE] = 7, [GREEN] = 4, [BLUE] = 3};
+#define COLORS_COUNT 4
+const Color CARD_COLORS[COLORS_COUNT] = {RED, GREEN, BLUE, WHITE};
+
+enum _CommandType_
+{
+  COMMAND_INVALID,
+  COMMAND_QUIT,
+  COMMAND_HELP,
+  COMMAND_PLACE,
+  COMMAND_DISCARD,
+  COMMAND_HINT,
+  COMMAND_NUMBER,
+};
+typedef enum _CommandType_ CommandType;
+
+// A command as it was entered at a prompt. The arguments are the words after the command, split at spaces, of which
+// only the first ones are converted to integers. The count tells how many words there were, but stops counting at one
+// more than fit into the arguments.
+struct _Command_
+{
+  CommandType type_;
+  int arguments_count_;
+  int arguments_[MAX_COMMAND_ARGUMENTS];
+};
+typedef struct _Command_ Command;
+
 struct _Card_
 {
   Color color_;
@@ -69,70 +247,860 @@ struct _Card_
 };
 typedef struct _Card_ Card;
 
-int checkMainArgumentsCount(int argc);
-int getPlayersCount(char *config_file);
+struct _CardArena_
+{
+  Card *cards_;
+  int capacity_;
+  int used_;
+};
+typedef struct _CardArena_ CardArena;
+
+// A set of card values stored as a 128 bit mask, with one bit for each value from 0 to 127
+struct _CardSet_
+{
+  uint64_t words_[CARD_SET_WORDS];
+};
+typedef struct _CardSet_ CardSet;
+
+// A row of cards in ascending order, together with running totals that are updated whenever a card is added
+struct _CardRow_
+{
+  Card *head_;
+  Card *tail_;
+  int length_;
+  int points_;
+  int min_value_;
+  int max_value_;
+  CardSet set_;
+};
+typedef struct _CardRow_ CardRow;
+
+// Finished boards in a struct-of-arrays layout. The points and the lengths of every row have an array of their own, so
+// the same row of several boards lies side by side and is scored with a single vector instruction.
+struct _BoardBatch_
+{
+  int32_t *row_points_[MAX_CARD_ROWS];
+  int32_t *row_lengths_[MAX_CARD_ROWS];
+  int32_t *points_;
+  int count_;
+  int capacity_;
+};
+typedef struct _BoardBatch_ BoardBatch;
+
+struct _Player_
+{
+  int id_;
+  Card *handcards_;
+  Card *chosencards_;
+  CardRow cardrows_[MAX_CARD_ROWS];
+  CardSet handset_;
+  CardSet chosenset_;
+  // The hand cards by their value, an entry is only valid while its value is in the hand card set
+  Card *hand_index_[CARD_SET_SIZE];
+  int bot_;
+};
+typedef struct _Player_ Player;
+
+// The points of a player together with the index of the player, used to rank the players at the end of a game
+struct _PlayerRank_
+{
+  int points_;
+  int index_;
+};
+typedef struct _PlayerRank_ PlayerRank;
+
+enum _GamePhase_
+{
+  PHASE_CHOOSING,
+  PHASE_ACTION,
+};
+typedef enum _GamePhase_ GamePhase;
+
+// A strategy takes the decisions of a player without any input. Built-in strategies work on the players directly,
+// strategies loaded from a plugin have no functions of their own and are asked through the plugin instead.
+struct _Strategy_
+{
+  const char *name_;
+  Card *(*chooseCard_)(const Player *player, const Player *opponent, uint64_t *random_state);
+  Card *(*chooseAction_)(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state);
+  const StrategyPlugin *plugin_;
+};
+typedef struct _Strategy_ Strategy;
+
+_Static_assert(MAX_CARD_ROWS == STRATEGY_ROWS_COUNT, "a strategy view holds every card row");
+
+struct _Options_
+{
+  char *config_file_;
+  long simulate_games_;
+  const Strategy *strategies_[MAX_STRATEGY_OPTIONS];
+  int strategies_count_;
+  int quiet_;
+  int bot_;
+  long search_time_ms_;
+  int solve_;
+  char *log_file_;
+  char *replay_file_;
+  char *save_file_;
+  char *load_file_;
+  char *serve_address_;
+  char *journal_file_;
+  long journal_sync_ms_;
+  char *journal_summary_file_;
+  int stats_;
+  char *tournament_file_;
+  long tournament_games_;
+  char *book_file_;
+  char *build_book_file_;
+  long book_games_;
+};
+typedef struct _Options_ Options;
+
+// A growing byte buffer that output is rendered into, so that it can be written with a single call
+struct _OutputBuffer_
+{
+  char *data_;
+  size_t length_;
+  size_t capacity_;
+};
+typedef struct _OutputBuffer_ OutputBuffer;
+
+// The status of a player is rendered into this buffer, which is reused for every status that is printed
+OutputBuffer status_output = {NULL, 0, 0};
+// In quiet mode no player status is printed, which is meant for games that are driven by other programs
+int quiet_mode = FALSE;
+
+// Reads lines from a file descriptor in large blocks. The bytes from start_ to length_ are read but not yet returned,
+// the bytes from start_ to scanned_ are known to contain no newline.
+struct _InputReader_
+{
+  int fd_;
+  char *buffer_;
+  size_t capacity_;
+  size_t start_;
+  size_t scanned_;
+  size_t length_;
+  int end_of_input_;
+};
+typedef struct _InputReader_ InputReader;
+
+// The input of the players, its buffer is reused for every line that is read
+InputReader player_input = {STDIN_FILENO, NULL, 0, 0, 0, 0, FALSE};
+
+enum _EventType_
+{
+  EVENT_CHOOSE = 1,
+  EVENT_PLACE,
+  EVENT_DISCARD,
+  EVENT_QUIT,
+  EVENT_RESULT,
+};
+typedef enum _EventType_ EventType;
+
+// A command that was accepted during a game. The index is the row number of a place event and the player number of a
+// result event, the value is the card of a command or the points of a result event. The time is counted in
+// milliseconds from the start of the game. In a log file every event takes EVENT_SIZE bytes in little endian order.
+struct _GameEvent_
+{
+  EventType type_;
+  int index_;
+  int value_;
+  uint32_t time_ms_;
+};
+typedef struct _GameEvent_ GameEvent;
+
+// The events of the game that is played. They are collected behind the space for the header of the game and written
+// to the end of the log file with a single call when the game ends. The header holds a hash of the deck, the number of
+// events and the time the game started. A game has at most one event for every card and a few more, so the events
+// always fit.
+struct _EventLog_
+{
+  const char *file_;
+  unsigned char data_[EVENT_LOG_HEADER_SIZE + MAX_GAME_EVENTS * EVENT_SIZE];
+  uint32_t events_count_;
+  uint32_t deck_hash_;
+  long long start_ns_;
+  uint64_t start_time_ms_;
+};
+typedef struct _EventLog_ EventLog;
+
+// The event log of the game, nothing is logged while no file is set
+EventLog event_log = {NULL, {0}, 0, 0, 0, 0};
+
+enum _ReplayStatus_
+{
+  REPLAY_CONTINUE,
+  REPLAY_FINISHED,
+  REPLAY_QUIT,
+  REPLAY_UNFINISHED,
+  REPLAY_INVALID,
+  REPLAY_CHANGED,
+};
+typedef enum _ReplayStatus_ ReplayStatus;
+
+struct _ReplayResult_
+{
+  long games_;
+  long games_by_status_[REPLAY_CHANGED + 1];
+  long long events_;
+  long first_failed_game_;
+};
+typedef struct _ReplayResult_ ReplayResult;
+
+// The result of a game as it is stored in the results journal. The players are ranked by their points, the record
+// keeps the points of the first two ranks and every player with the most points is a winner.
+struct _JournalRecord_
+{
+  uint32_t deck_hash_;
+  uint32_t duration_us_;
+  uint64_t finished_time_ms_;
+  uint64_t winners_;
+  int32_t first_points_;
+  int32_t second_points_;
+  uint32_t players_count_;
+};
+typedef struct _JournalRecord_ JournalRecord;
+
+// Records that are collected in memory and written to the journal with a single call. Every thread that produces
+// results has its own batch, so only writing a full batch has to be serialized.
+struct _JournalBatch_
+{
+  unsigned char data_[JOURNAL_BATCH_RECORDS * JOURNAL_RECORD_SIZE];
+  int records_count_;
+  long long first_record_ns_;
+};
+typedef struct _JournalBatch_ JournalBatch;
+
+// An append-only file of fixed-size game results. A batch is written once it is full or once its first record has
+// waited for the sync interval, and written records are flushed to the disk at most once per sync interval. Every
+// record carries a checksum, so a record that was torn by a crash is recognized and skipped when the journal is read.
+struct _Journal_
+{
+  int fd_;
+  long long sync_interval_ns_;
+  long long last_sync_ns_;
+  int unsynced_;
+  int error_;
+  pthread_mutex_t mutex_;
+  JournalBatch batch_;
+};
+typedef struct _Journal_ Journal;
+
+// The journal that the results of all games are written to, no results are journaled while its file is not open
+Journal results_journal = {-1, 0, 0, FALSE, 0, PTHREAD_MUTEX_INITIALIZER, {{0}, 0, 0}};
+
+#ifdef A3_STATS
+// Counters of what the engine does at runtime, they are only compiled in with -DA3_STATS. Each thread counts on its
+// own, so the counters of the main thread describe the game at the console without the work of the search workers.
+struct _Stats_
+{
+  long long cards_allocated_;
+  long long cards_freed_;
+  long long hand_nodes_visited_;
+  long long chosen_nodes_visited_;
+  long long row_nodes_visited_;
+  long long input_bytes_read_;
+  long long invalid_commands_[INVALID_COMMAND_TYPES];
+  long long choosing_phases_;
+  long long choosing_phase_ns_;
+  long long action_phases_;
+  long long action_phase_ns_;
+  long long scoring_ns_;
+};
+typedef struct _Stats_ Stats;
+
+_Thread_local Stats stats;
+
+// The messages of invalid commands and the names they are counted under, in the same order
+const char *INVALID_COMMAND_MESSAGES[INVALID_COMMAND_TYPES] = {INVALID_COMMAND, WRONG_PARAMETERS_COUNT,
+                                                               WRONG_HANDCARDS_NUMBER, WRONG_CHOSENCARDS_NUMBER,
+                                                               WRONG_ROW_NUMBER, CARD_CANNOT_EXTEND_ROW};
+const char *INVALID_COMMAND_NAMES[INVALID_COMMAND_TYPES] = {"invalid_command", "wrong_parameters_count",
+                                                            "wrong_handcards_number", "wrong_chosencards_number",
+                                                            "wrong_row_number", "card_cannot_extend_row"};
+
+#define STATS_ADD(counter, amount) (stats.counter += (amount))
+#define STATS_INVALID_COMMAND(message) countInvalidCommand(message)
+#define STATS_NOW() getMonotonicTimeNs()
+#else
+// Without -DA3_STATS the counters are compiled out, the arguments are only evaluated to keep the compiler quiet
+#define STATS_ADD(counter, amount) ((void)(amount))
+#define STATS_INVALID_COMMAND(message) ((void)(message))
+#define STATS_NOW() 0LL
+#endif
+
+// A game that is played over a connection to the server. It holds the same state as the interactive game, which is
+// moved forward one command at a time. Input is collected until a line is complete and output is collected until the
+// connection can take it, so a session never blocks the server.
+struct _Session_
+{
+  int fd_;
+  CardArena arena_;
+  Player players_[2];
+  GamePhase phase_;
+  int current_player_;
+  int skip_prompt_;
+  int closing_;
+  uint32_t events_;
+  uint64_t random_state_;
+  char input_[SESSION_INPUT_SIZE + 1];
+  size_t input_length_;
+  OutputBuffer output_;
+  size_t output_sent_;
+  uint32_t deck_hash_;
+  long long start_ns_;
+};
+typedef struct _Session_ Session;
+
+// The server deals the cards of the config file to every session, the deck is loaded once when the server starts
+struct _Server_
+{
+  int listen_fd_;
+  int epoll_fd_;
+  CardArena deck_arena_;
+  Player deck_players_[2];
+  int players_count_;
+  uint32_t deck_hash_;
+  long sessions_count_;
+};
+typedef struct _Server_ Server;
+
+struct _SimulationResult_
+{
+  long games_;
+  long wins_[2];
+  long ties_;
+  long long points_[2];
+};
+typedef struct _SimulationResult_ SimulationResult;
+
+struct _SimulationJob_
+{
+  CardArena deck_arena_;
+  Player deck_players_[2];
+  const Strategy *strategies_[2];
+  uint32_t deck_hash_;
+  long games_count_;
+  atomic_long next_game_;
+};
+typedef struct _SimulationJob_ SimulationJob;
+
+struct _SimulationWorker_
+{
+  pthread_t thread_;
+  SimulationJob *job_;
+  CardArena arena_;
+  SimulationResult result_;
+  JournalBatch journal_batch_;
+  int error_;
+};
+typedef struct _SimulationWorker_ SimulationWorker;
+
+// A deck of a tournament, it is dealt once and copied for every game that is played with it
+struct _TournamentDeck_
+{
+  CardArena arena_;
+  Player players_[2];
+  uint32_t deck_hash_;
+};
+typedef struct _TournamentDeck_ TournamentDeck;
+
+// The standing of a strategy in a tournament
+struct _TournamentStanding_
+{
+  int strategy_index_;
+  long games_;
+  long wins_;
+  long ties_;
+  long losses_;
+  long long points_;
+};
+typedef struct _TournamentStanding_ TournamentStanding;
+
+// The numbers of the games a tournament worker has not played yet. The worker takes chunks from the beginning of its
+// range, workers that have run out of games steal the second half of it.
+struct _GameRange_
+{
+  pthread_mutex_t mutex_;
+  long begin_;
+  long end_;
+};
+typedef struct _GameRange_ GameRange;
+
+struct _TournamentJob_
+{
+  TournamentDeck *decks_;
+  int decks_count_;
+  const Strategy *strategies_[MAX_STRATEGY_OPTIONS];
+  int strategies_count_;
+  long games_per_pairing_;
+  long pairings_count_;
+  long games_count_;
+  struct _TournamentWorker_ *workers_;
+  long workers_count_;
+};
+typedef struct _TournamentJob_ TournamentJob;
+
+struct _TournamentWorker_
+{
+  pthread_t thread_;
+  TournamentJob *job_;
+  long index_;
+  GameRange range_;
+  CardArena arena_;
+  TournamentStanding standings_[MAX_STRATEGY_OPTIONS];
+  JournalBatch journal_batch_;
+  long stolen_games_;
+  int error_;
+};
+typedef struct _TournamentWorker_ TournamentWorker;
+
+// An opening book that is mapped into memory, data_ is NULL while no book is mapped
+struct _OpeningBook_
+{
+  const unsigned char *data_;
+  size_t size_;
+  uint32_t capacity_;
+};
+typedef struct _OpeningBook_ OpeningBook;
+
+// The cards to keep for a hand of the first round, the margin is the expected lead in hundredths of a point
+struct _OpeningBookEntry_
+{
+  uint64_t key_;
+  int values_[CARDS_TO_KEEP];
+  int margin_;
+};
+typedef struct _OpeningBookEntry_ OpeningBookEntry;
+
+struct _BookBuilder_
+{
+  TournamentJob decks_;
+  long games_;
+  atomic_int next_deck_;
+  OpeningBookEntry *entries_;
+};
+typedef struct _BookBuilder_ BookBuilder;
+
+struct _BookWorker_
+{
+  pthread_t thread_;
+  BookBuilder *builder_;
+  CardArena arena_;
+  int error_;
+};
+typedef struct _BookWorker_ BookWorker;
+
+// A move the search can recommend: the cards to keep in the choosing phase, or a card and the index of the row to
+// place it on (-1 to discard it) in the action phase. Cards are identified by their values, so a move can be applied
+// to every copy of the game.
+struct _SearchMove_
+{
+  int values_[CARDS_TO_KEEP];
+  int values_count_;
+  int row_number_;
+};
+typedef struct _SearchMove_ SearchMove;
+
+// The cards the searching player cannot see are dealt anew in every playout from the values he has not seen
+struct _SearchJob_
+{
+  const Player *players_[2];
+  GamePhase phase_;
+  int player_index_;
+  int cards_count_;
+  SearchMove moves_[MAX_SEARCH_MOVES];
+  int moves_count_;
+  long long deadline_ns_;
+  int hide_opponent_hand_;
+  int unseen_values_[MAX_CARD_VALUE];
+  int unseen_count_;
+};
+typedef struct _SearchJob_ SearchJob;
+
+// Every search thread plays out its own games and keeps its own statistics, they are only added up at the end
+struct _SearchWorker_
+{
+  pthread_t thread_;
+  const SearchJob *job_;
+  CardArena arena_;
+  uint64_t random_state_;
+  int unseen_values_[MAX_CARD_VALUE];
+  long visits_[MAX_SEARCH_MOVES];
+  double rewards_[MAX_SEARCH_MOVES];
+  int error_;
+};
+typedef struct _SearchWorker_ SearchWorker;
+
+// A row as the solver sees it, only its ends, its length and its points matter for the rest of the game. The ends are
+// the numbers of the cards in the deck of the solver.
+struct _SolverRow_
+{
+  int length_;
+  int points_;
+  int min_card_;
+  int max_card_;
+};
+typedef struct _SolverRow_ SolverRow;
+
+// A position of the game for the solver. The cards of the deck are numbered in ascending order of their values and the
+// hand and chosen cards are bit masks over these numbers. The turn is the next of the four steps of a round: player 1
+// chooses, player 2 chooses, player 1 acts, player 2 acts. As the players take turns, the player to move is turn_ % 2.
+struct _SolverState_
+{
+  uint32_t handcards_[2];
+  uint32_t chosencards_[2];
+  SolverRow cardrows_[2][MAX_CARD_ROWS];
+  int turn_;
+};
+typedef struct _SolverState_ SolverState;
+
+// A move of the solver: the cards to keep, or all chosen cards in the order they are played together with the index
+// of the row each of them is placed on (-1 to discard it). The order is only used to try promising moves first.
+struct _SolverMove_
+{
+  int cards_[CARDS_TO_KEEP];
+  int rows_[CARDS_TO_KEEP];
+  int cards_count_;
+  int order_;
+};
+typedef struct _SolverMove_ SolverMove;
+
+enum _SolverBound_
+{
+  BOUND_NONE,
+  BOUND_EXACT,
+  BOUND_LOWER,
+  BOUND_UPPER,
+};
+typedef enum _SolverBound_ SolverBound;
+
+// An entry of the transposition table, the value is exact or a bound depending on the alpha-beta window it was found in
+struct _SolverEntry_
+{
+  uint64_t key_;
+  int value_;
+  unsigned char bound_;
+  unsigned char best_move_;
+};
+typedef struct _SolverEntry_ SolverEntry;
+
+struct _Solver_
+{
+  int deck_size_;
+  int values_[MAX_SOLVER_CARDS];
+  int points_[MAX_SOLVER_CARDS];
+  SolverEntry *table_;
+  uint64_t table_mask_;
+  long long positions_;
+  long long table_hits_;
+};
+typedef struct _Solver_ Solver;
+
+// The time the search may take for a single move
+long search_time_ms = DEFAULT_SEARCH_TIME_MS;
+
+// The opening book the search looks up the first cards to keep in, it is shared by all threads
+OpeningBook opening_book = {NULL, 0, 0};
+
+// The strategy the computer plays with at the console, NULL to play with the search
+const Strategy *bot_strategy = NULL;
+uint64_t bot_random_state = 0;
+
+// The strategies loaded from plugins, they are looked up by name like the built-in strategies
+Strategy plugin_strategies[MAX_STRATEGY_PLUGINS];
+int plugin_strategies_count = 0;
+
+int parseArguments(int argc, char *argv[], Options *options);
 void printWelcomeMessage(int players_count);
 void printCardChoosingPhase();
 void printActionPhase();
 
 // File functions
 FILE *openFile(char *config_file);
-int checkConfigFile(char *config_file);
+int loadConfigFile(char *config_file, CardArena *arena, int *players_count, Player *players, int max_players_count);
+char *readConfigFile(FILE *file, char *content, size_t start, int lines_count, size_t *length);
+char *nextConfigLine(char **cursor, const char *end);
 
 // Card functions
-Card *createCard(char *config_file_line);
-int assignCardsToPlayers(Card **player_one_handcards, Card **player_two_handcards, char *config_file);
-Card *getCardFromHand(Card *player_handcards, int card_number);
-Card *getCardFromChosen(Card *player_chosencards, int card_number);
-int exchangePlayerCards(Card **player_one_handcards, Card **player_two_handcards);
+int initCardArena(CardArena *arena, int capacity);
+void resetCardArena(CardArena *arena);
+void freeCardArena(CardArena *arena);
+Card *allocateCard(CardArena *arena);
+void addToCardSet(CardSet *set, int value);
+void removeFromCardSet(CardSet *set, int value);
+int isInCardSet(const CardSet *set, int value);
+int createCard(CardArena *arena, char *config_file_line, Card **card);
+Card *getCardFromHand(const Player *player, int card_number);
+Card *getCardFromChosen(const Player *player, int card_number);
+int exchangePlayerCards(Player *player_one, Player *player_two);
+void passHandCards(Player *players, int players_count);
 int sortCards(Card **player_cards);
 Color parseColor(char *color);
-void swapCards(Card **first_card, Card **second_card);
+void bucketSortCards(Card **head);
+Card *mergeSortCards(Card *head, int cards_count);
 
 // Player functions
-void printPlayer(int player_id, Card **player_handcards, Card **player_chosencards, Card ***player_cardrows);
-int addCardToHand(Card **player_handcards, Card *card);
-void addCardToChosen(Card **player_chosencards, Card *card);
-int removeCardFromHand(Card **player_handcards, Card *card);
-int removeCardFromChosen(Card **player_chosencards, Card *card);
-int addCardToRow(Card **player_cardrows, Card *card, int row_number);
-int calculatePlayerPoints(Card ***player_cardrows);
-
-int placeAction(char *input, int *skip_prompt, int player_id, Card **player_handcards,
-                Card **player_chosencards, Card ***player_cardrows);
-int discardAction(char *input, int *skip_prompt, int player_id, Card **player_handcards,
-                  Card **player_chosencards, Card ***player_cardrows);
+void initPlayer(Player *player, int player_id);
+void indexHandCard(Player *player, Card *card);
+void indexHandCards(Player *player);
+void printPlayer(const Player *player);
+void addCardToChosen(Player *player, Card *card);
+int removeCardFromHand(Player *player, Card *card);
+int removeCardFromChosen(Player *player, Card *card);
+int addCardToRow(Player *player, Card *card, int row_number);
+int calculatePlayerPoints(const CardRow *player_cardrows);
+int initBoardBatch(BoardBatch *batch, int capacity);
+void freeBoardBatch(BoardBatch *batch);
+int addBoardToBatch(BoardBatch *batch, const CardRow *cardrows);
+void scoreBoardBatch(BoardBatch *batch);
+int scoreBatchBoard(const BoardBatch *batch, int index);
+
+int placeAction(const Command *command, int *skip_prompt, Player *player);
+int discardAction(const Command *command, int *skip_prompt, Player *player);
+const char *applyPlaceCommand(const Command *command, Player *player);
+const char *applyDiscardCommand(const Command *command, Player *player);
 
 // Ask user input
-int chooseCardToKeep(int player_id, Card **player_handcards, Card **player_chosencards);
-int cardChoosingPhase(Card **player_one_handcards, Card **player_one_chosencards, Card ***player_one_cardrows,
-                      Card **player_two_handcards, Card **player_two_chosencards, Card ***player_two_cardrows);
-int actionChoosingPhase(Card **player_one_handcards, Card **player_one_chosencards, Card ***player_one_cardrows,
-                        Card **player_two_handcards, Card **player_two_chosencards, Card ***player_two_cardrows);
-int isActionInputCorrect(char *row_number, const char *card_number);
-int actionChoosingLoop(int player_id, Card **player_handcards, Card **player_chosencards, Card ***player_cardrows);
-void freePlayer(Card **player_handcards, Card **player_chosencards, Card ***player_cardrows);
-void printPlayerPoints(char *config_file, Card ***player_one_cardrows, Card ***player_two_cardrows);
-void writePlayerPointsToFile(char *config_file, int player_one_points, int player_two_points);
-void printPlayerHandCards(Card *const *player_handcards);
-void printPlayerChosenCards(Card *const *player_chosencards);
-void printPlayerCardRows(Card **const *player_cardrows);
-void helpAction(int player_id, Card **player_handcards, Card **player_chosencards, Card ***player_cardrows);
-void singleRowPointsCount(Card *head, int *points, int *row_length);
-void freeLinkedList(Card* head);
-char* readInput();
-void convertToLowercaseAndTrim(char *str);
+int chooseCardToKeep(Player *player, const Player *opponent);
+int cardChoosingPhase(Player *players, int players_count, int *current_player);
+int actionChoosingPhase(Player *players, int players_count, int *current_player);
+int isGameOver(const Player *players, int players_count);
+int actionChoosingLoop(Player *player, const Player *opponent);
+void printPlayerPoints(char *config_file, const Player *players, int players_count, int *points);
+void renderPlayerPoints(OutputBuffer *buffer, const int *points, int players_count);
+int comparePlayerRanks(const void *first, const void *second);
+void writePlayerPointsToFile(char *config_file, const int *points, int players_count);
+void renderPlayer(OutputBuffer *buffer, const Player *player);
+void renderPlayerHandCards(OutputBuffer *buffer, Card *const *player_handcards);
+void renderPlayerChosenCards(OutputBuffer *buffer, Card *const *player_chosencards);
+void renderPlayerCardRows(OutputBuffer *buffer, const CardRow *player_cardrows);
+void appendCardLabel(OutputBuffer *buffer, const Card *card, char separator);
+void appendToOutputBuffer(OutputBuffer *buffer, const char *data, size_t length);
+void appendString(OutputBuffer *buffer, const char *string);
+void appendFormatted(OutputBuffer *buffer, const char *format, ...);
+void flushOutputBuffer(OutputBuffer *buffer, FILE *stream);
+void freeOutputBuffer(OutputBuffer *buffer);
+void helpAction(const Player *player);
+int hintAction(const Player *player, const Player *opponent, GamePhase phase);
+int botChooseCardToKeep(Player *player, const Player *opponent);
+int botActionChoosingLoop(Player *player, const Player *opponent);
+int readInput(char **line);
+void printInvalidCommand(const char *message);
+#ifdef A3_STATS
+void countInvalidCommand(const char *message);
+#endif
+void printStats(void);
+int fillInputReader(InputReader *reader);
+void freeInputReader(InputReader *reader);
+void parseActionCommand(const char *input, Command *command);
+void parseChoosingCommand(const char *input, Command *command);
+void trimCommand(const char *input, const char **start, const char **end);
+int matchCommandKeyword(const char **cursor, const char *end, const char *keyword);
+void parseCommandArguments(const char *cursor, const char *end, Command *command);
+int parseInteger(const char *start, const char *end);
+int getCardPoints(const Card *card);
+int canCardExtendRow(const CardRow *row, const Card *card);
+int copyCardList(CardArena *arena, const Card *head, Card **copy);
+
+// Simulation functions
+int runSimulation(const Options *options);
+void *simulationWorker(void *argument);
+int runTournament(const Options *options);
+int loadTournamentDecks(const char *deck_list_file, TournamentJob *job);
+void freeTournamentDecks(TournamentJob *job);
+void *tournamentWorker(void *argument);
+int takeTournamentGames(TournamentWorker *worker, long *first_game, long *last_game);
+int stealTournamentGames(TournamentWorker *worker);
+int playTournamentGame(TournamentWorker *worker, long game);
+int compareTournamentStandings(const void *first, const void *second);
+
+// Opening book functions
+int openOpeningBook(OpeningBook *book, const char *book_file);
+uint64_t hashOpeningHand(const Player *player);
+int probeOpeningBook(const OpeningBook *book, const Player *player, SearchMove *move);
+void encodeOpeningBookEntry(const OpeningBookEntry *entry, unsigned char *bytes);
+void decodeOpeningBookEntry(const unsigned char *bytes, OpeningBookEntry *entry);
+int runBookBuilder(const Options *options);
+void *bookWorker(void *argument);
+int findOpeningKeeps(BookWorker *worker, const Player *deck_players, int player_index, uint64_t seed,
+                     OpeningBookEntry *entries);
+void keepOpeningCard(Player *player, int value);
+int writeOpeningBook(const char *book_file, const OpeningBookEntry *entries, int entries_count, int *hands_count);
+int simulateGame(CardArena *arena, const Player *deck_players, const Strategy *const *strategies,
+                 uint64_t *random_state, int *points);
+void simulateChooseCard(Player *player, const Player *opponent, const Strategy *strategy, uint64_t *random_state);
+void simulateAction(Player *player, const Player *opponent, const Strategy *strategy, uint64_t *random_state);
+void playRemainingGame(Player *players, const Strategy *const *strategies, GamePhase phase, int first_player,
+                       uint64_t *random_state);
+int copyDeckPlayers(CardArena *arena, const Player *deck_players, Player *players);
+int countCards(const Card *head);
+const Strategy *findStrategy(const char *name);
+int loadStrategyPlugin(const char *plugin_file);
+Card *askStrategyForCard(const Strategy *strategy, const Player *player, const Player *opponent,
+                         uint64_t *random_state);
+Card *askStrategyForAction(const Strategy *strategy, const Player *player, const Player *opponent, int *row_number,
+                           uint64_t *random_state);
+void fillStrategyView(StrategyView *view, StrategyCard *cards, const Player *player, const Player *opponent);
+void fillStrategyCardList(StrategyCardList *list, StrategyCard *cards, int *cards_count, const Card *head);
+uint64_t nextRandom(uint64_t *random_state);
+int parseDeckSeed(const char *line, uint64_t *seed);
+int generateDeck(CardArena *arena, uint64_t seed, int players_count, Player *players);
+void dealCard(Player *player, Card **last_card, Card *card);
+void sortHandCards(Player *players, int players_count);
+Card *createRandomCard(CardArena *arena, uint64_t *random_state, int *values, int *values_left,
+                       const CardSet *excluded);
+int randomBelow(uint64_t *random_state, int bound);
+Card *getRandomCard(Card *head, uint64_t *random_state);
+Card *chooseRandomCard(const Player *player, const Player *opponent, uint64_t *random_state);
+Card *chooseRandomAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state);
+Card *chooseGreedyCard(const Player *player, const Player *opponent, uint64_t *random_state);
+Card *chooseGreedyAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state);
+Card *choosePlayoutCard(const Player *player, const Player *opponent, uint64_t *random_state);
+Card *choosePlayoutAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state);
+Card *chooseSearchCard(const Player *player, const Player *opponent, uint64_t *random_state);
+Card *chooseSearchAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state);
+
+// Search functions
+int searchBestMove(const Player *player, const Player *opponent, GamePhase phase, SearchMove *best_move);
+void generateSearchMoves(SearchJob *job);
+void *searchWorker(void *argument);
+int selectSearchMove(const SearchWorker *worker, long total_visits);
+int runPlayout(SearchWorker *worker, const SearchMove *move, double *reward);
+void applySearchMove(Player *player, const SearchMove *move, GamePhase phase);
+int isOpponentHandHidden(const Player *player, GamePhase phase);
+int collectUnseenValues(const Player *player, const Player *opponent, int hide_opponent_hand, int *unseen_values);
+void dealHiddenCards(Player *opponent, int hide_hand, int *unseen_values, int unseen_count, uint64_t *random_state);
+int copyPlayer(CardArena *arena, const Player *source, Player *copy);
+long long getMonotonicTimeNs(void);
+double squareRoot(double value);
+int binaryLogarithm(long value);
+
+// Solver functions
+int runSolver(const Options *options);
+int initSolver(Solver *solver, const Player *players, SolverState *state);
+void freeSolver(Solver *solver);
+int solvePosition(Solver *solver, const SolverState *state, int alpha, int beta);
+int boundSolverPosition(Solver *solver, const SolverState *state, int player_index, int alpha, int beta);
+int isSolverGameOver(const SolverState *state);
+int isSolverRestIndependent(const SolverState *state);
+int solveIndependentRest(Solver *solver, const SolverState *state);
+int solveRestPlacements(Solver *solver, const SolverState *state, int player_index);
+int solvePlacements(Solver *solver, const SolverRow *rows, uint32_t chosencards, uint32_t handcards);
+int evaluateSolverState(const SolverState *state, int player_index);
+int calculateSolverRowsPoints(const SolverRow *rows);
+int calculateSolverPointsBound(const Solver *solver, const SolverRow *rows, uint32_t cards);
+int generateSolverMoves(const Solver *solver, const SolverState *state, SolverMove *moves);
+int placeSolverCards(const Solver *solver, const SolverRow *rows, const SolverMove *move);
+void applySolverMove(const Solver *solver, SolverState *state, const SolverMove *move);
+int canCardExtendSolverRow(const SolverRow *row, int card);
+void addCardToSolverRow(SolverRow *row, int card, int points);
+uint64_t hashSolverState(const SolverState *state);
+uint64_t mixSolverKey(uint64_t key, uint64_t word);
+int countBits(uint32_t mask);
+int findPrincipalVariation(Solver *solver, SolverState *state, int value, SolverMove *line);
+void printPrincipalVariation(const Solver *solver, const SolverMove *line, int line_length);
+
+// Event log functions
+void startEventLog(const Player *players);
+void logEvent(EventType type, int index, int value);
+void writeEventLog(const Player *player_one, const Player *player_two, int finished);
+uint32_t hashDeck(const Player *players, int players_count);
+void encodeEvent(const GameEvent *event, unsigned char *bytes);
+void decodeEvent(const unsigned char *bytes, GameEvent *event);
+void writeLittleEndian(unsigned char *bytes, uint64_t value, int bytes_count);
+uint64_t readLittleEndian(const unsigned char *bytes, int bytes_count);
+int runReplay(const Options *options);
+int readEventLogGame(FILE *file, unsigned char *events, uint32_t *deck_hash, uint32_t *events_count);
+int replayGame(CardArena *arena, const Player *deck_players, const unsigned char *events, uint32_t events_count,
+               ReplayStatus *status);
+ReplayStatus replayNextEvent(Player *player, GamePhase phase, const unsigned char *events, uint32_t events_count,
+                             uint32_t *next);
 
+// Snapshot functions
+int saveSnapshot(const Player *player_one, const Player *player_two, GamePhase phase, int current_player,
+                 int players_count, uint32_t deck_hash, unsigned char *snapshot);
+int restoreSnapshot(const unsigned char *snapshot, CardArena *arena, Player *player_one, Player *player_two,
+                    GamePhase *phase, int *current_player, int *players_count, uint32_t *deck_hash);
+int restoreSnapshotCard(const unsigned char *bytes, CardArena *arena, Card **card);
+int isSnapshotReachable(const unsigned char *counts, GamePhase phase, int current_player);
+int writeSnapshotFile(const char *snapshot_file, const unsigned char *snapshot);
+int readSnapshotFile(const char *snapshot_file, unsigned char *snapshot);
+
+// Server functions
+int runServer(const Options *options);
+int openServerSocket(const char *address);
+int setNonBlocking(int fd);
+void acceptSessions(Server *server);
+Session *startSession(const Server *server, int fd);
+void closeSession(Server *server, Session *session);
+int readSession(Session *session);
+int writeSession(Server *server, Session *session);
+void handleSessionLine(Session *session, const char *line);
+void handleSessionChoice(Session *session, const char *line);
+void handleSessionAction(Session *session, const char *line);
+void hintSession(Session *session);
+void beginSessionTurn(Session *session);
+void endSessionTurn(Session *session);
+void promptSession(Session *session);
+
+// Results journal functions
+int openJournal(Journal *journal, const char *journal_file, long sync_interval_ms);
+int closeJournal(Journal *journal);
+void fillJournalRecord(JournalRecord *record, uint32_t deck_hash, const int *points, int players_count,
+                       long long start_ns);
+void addJournalRecord(Journal *journal, JournalBatch *batch, const JournalRecord *record);
+void flushJournalBatch(Journal *journal, JournalBatch *batch, int force);
+int writeJournalBatch(Journal *journal, JournalBatch *batch);
+void encodeJournalRecord(const JournalRecord *record, unsigned char *bytes);
+int decodeJournalRecord(const unsigned char *bytes, JournalRecord *record);
+uint32_t hashBytes(const unsigned char *bytes, size_t length);
+int runJournalSummary(const Options *options);
+
+const Strategy STRATEGIES[] = {
+  {"random", chooseRandomCard, chooseRandomAction, NULL},
+  {"greedy", chooseGreedyCard, chooseGreedyAction, NULL},
+  {"mcts", chooseSearchCard, chooseSearchAction, NULL},
+};
+const int STRATEGIES_COUNT = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+// The search plays out games with this strategy, it is not meant to be selected
+const Strategy PLAYOUT_STRATEGY = {"playout", choosePlayoutCard, choosePlayoutAction, NULL};
+
+// Programs that build on the game, like the benchmark in tools/, include this file with A3_NO_MAIN defined
+#ifndef A3_NO_MAIN
 //---------------------------------------------------------------------------------------------------------------------
 ///
 /// This is the main function of the program. It checks if the correct number of arguments is given and if the config
-/// file is valid. Then it creates the players and starts the game. The game takes place in a loop until
-/// both players have no hand cards and no chosencards left. In each loop the player chooses two cards from his hand
-/// cards and adds them to his chosen cards. Then the player chooses a chosen card and adds it to a row. The game ends
-/// when both players have no hand cards and no chosencards left. The player with the most points wins the game.
+/// file is valid. Then it creates the players and starts the game. The game takes place in a loop until a player has no
+/// hand cards and no chosencards left. In each loop the player chooses two cards from his hand cards and adds them to
+/// his chosen cards. Then the player chooses a chosen card and adds it to a row. The game ends when a player has no
+/// hand cards and no chosencards left. The player with the most points wins the game. With --simulate <games> the given
+/// number of games is played headless on all cores instead, with the decisions taken by the strategies selected with
+/// --strategy <name> (once for each player, "random" by default). With --quiet the status of the players is not
+/// printed. With --bot every player but the first is played by the computer, which searches for its moves for
+/// --bot-time <milliseconds> per move. The same search answers the hint command. With --solve the game is not played,
+/// instead the optimal play of both players for the deck of the config file is computed, with --quiet without its
+/// timing. With --log <file> every accepted command of the game is appended to a binary event log, and --replay <file>
+/// executes all games of such a log again against the config file, without prompts and as fast as possible, with
+/// --quiet it leaves out its timing. With --save <file> a game that is quit is saved as a snapshot, which --load <file>
+/// continues instead of dealing the config file again. With --serve <port or socket path> games are hosted for clients
+/// that connect to a localhost TCP port or a Unix domain socket, every connection plays its own game with the deck of
+/// the config file. The game at the console is played by as many players as the config file names, up to MAX_PLAYERS,
+/// who pass their hand cards around a ring. The other modes, as well as logs and snapshots, support two players only,
+/// they reject a config file for more players with an error of its own and exit with 3. With --journal <file> the
+/// results of all games are appended to a results journal instead of the config file, they are written in batches and
+/// flushed to the disk every --journal-sync <milliseconds>. --journal-summary <file> adds up the results of such a
+/// journal. --tournament <deck list> plays every pair of strategies against each other on every deck of the list on all
+/// cores and prints the standings, with --journal its games are journaled as well. --plugin <shared object> loads a
+/// strategy plugin, which can then be selected with --strategy like a built-in strategy. With --bot and --strategy the
+/// computer plays with the strategy instead of searching for its moves. --book <file> maps an opening book, in which
+/// the search looks up the cards to keep in the first round. With --build-book <file> the config file is a deck list,
+/// and the best first keeps of its decks are found with --book-games <games> playouts for every pair of cards and
+/// written to a new opening book. With --stats the counters of the game at the console are written to stderr as a JSON
+/// document when it ends, if they were compiled in with -DA3_STATS.
 ///
 /// @param argc The number of arguments
-/// @param argv The arguments, argv[1] is the config file
+/// @param argv The arguments, the config file and the options
 ///
 /// @return
 ///      0 if the program was executed successfully
@@ -143,88 +1111,197 @@ void convertToLowercaseAndTrim(char *str);
 //
 int main(int argc, char *argv[])
 {
-  if (checkMainArgumentsCount(argc) != 0)
+  Options options;
+  if (parseArguments(argc, argv, &options) != 0)
   {
     return WRONG_ARGUMENT_COUNT;
   }
-  int config_file_error = checkConfigFile(argv[1]);
-  if (config_file_error != 0)
+  search_time_ms = options.search_time_ms_;
+  // With a strategy option the computer plays with that strategy at the console instead of searching
+  if (options.strategies_count_ > 0)
   {
-    return config_file_error;
+    bot_strategy = options.strategies_[1];
+    bot_random_state = (uint64_t)getMonotonicTimeNs();
   }
-  int players_count = getPlayersCount(argv[1]);
-  if (players_count == -1)
+  if (options.journal_summary_file_ != NULL)
   {
-    return CANNOT_OPEN_FILE;
+    return runJournalSummary(&options);
   }
-  printWelcomeMessage(players_count);
-  Card *player_one_handcards = NULL;
-  Card *player_one_chosencards = NULL;
-  Card **player_one_cardrows = malloc(sizeof(Card**) * MAX_CARD_ROWS);
-  if (player_one_cardrows == NULL)
+  if (options.solve_)
   {
-    return MEMORY_ALLOCATION_ERROR;
+    return runSolver(&options);
+  }
+  if (options.replay_file_ != NULL)
+  {
+    return runReplay(&options);
+  }
+  if (options.build_book_file_ != NULL)
+  {
+    return runBookBuilder(&options);
+  }
+  if (options.book_file_ != NULL)
+  {
+    int book_error = openOpeningBook(&opening_book, options.book_file_);
+    if (book_error != 0)
+    {
+      return book_error;
+    }
+  }
+  if (options.journal_file_ != NULL)
+  {
+    int journal_error = openJournal(&results_journal, options.journal_file_, options.journal_sync_ms_);
+    if (journal_error != 0)
+    {
+      return journal_error;
+    }
+  }
+  if (options.tournament_file_ != NULL)
+  {
+    return runTournament(&options);
   }
-  Card *player_two_handcards = NULL;
-  Card *player_two_chosencards = NULL;
-  Card **player_two_cardrows = malloc(sizeof(Card**) * MAX_CARD_ROWS);
-  if (player_two_cardrows == NULL)
+  if (options.serve_address_ != NULL)
   {
-    free(player_one_cardrows);
+    return runServer(&options);
+  }
+  if (options.simulate_games_ > 0)
+  {
+    return runSimulation(&options);
+  }
+  quiet_mode = options.quiet_;
+  int players_count = 0;
+  CardArena arena;
+  if (initCardArena(&arena, MAX_DECK_SIZE) != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
     return MEMORY_ALLOCATION_ERROR;
   }
-  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  Player players[MAX_PLAYERS];
+  GamePhase phase = PHASE_CHOOSING;
+  int current_player = 0;
+  uint32_t deck_hash = 0;
+  int config_file_error = 0;
+  if (options.load_file_ != NULL)
+  {
+    unsigned char snapshot[SNAPSHOT_SIZE];
+    config_file_error = readSnapshotFile(options.load_file_, snapshot);
+    if (config_file_error == 0)
+    {
+      config_file_error = restoreSnapshot(snapshot, &arena, &players[0], &players[1], &phase, &current_player,
+                                          &players_count, &deck_hash);
+      if (config_file_error != 0)
+      {
+        printf("Error: Invalid file: %s\n", options.load_file_);
+      }
+    }
+  }
+  else
+  {
+    config_file_error = loadConfigFile(options.config_file_, &arena, &players_count, players, MAX_PLAYERS);
+  }
+  if (config_file_error != 0)
   {
-    player_one_cardrows[i] = NULL;
-    player_two_cardrows[i] = NULL;
+    freeCardArena(&arena);
+    return config_file_error;
+  }
+  // A continued game keeps the hash of the deck it was dealt, so its result in the journal names the same deck
+  if (options.load_file_ == NULL)
+  {
+    deck_hash = hashDeck(players, players_count);
+  }
+  // The computer plays every player except the first one
+  for (int i = 1; i < players_count; i++)
+  {
+    players[i].bot_ = options.bot_;
   }
-  int assign_cards_error = assignCardsToPlayers(&player_one_handcards, &player_two_handcards, argv[1]);
-  if (assign_cards_error != 0)
+  // A log starts with the cards that are dealt, so a game that is continued from a snapshot is not logged. Logs and
+  // snapshots hold two players, so larger tables are neither logged nor saved.
+  if (options.log_file_ != NULL && options.load_file_ == NULL && players_count == MIN_PLAYERS)
   {
-    free(player_one_cardrows);
-    free(player_two_cardrows);
-    return assign_cards_error;
+    event_log.file_ = options.log_file_;
+    startEventLog(players);
   }
-  sortCards(&player_one_handcards);
-  sortCards(&player_two_handcards);
+  long long start_ns = getMonotonicTimeNs();
+  printWelcomeMessage(players_count);
   int break_early = FALSE;
   do
   {
-    printCardChoosingPhase();
-    if (cardChoosingPhase(&player_one_handcards, &player_one_chosencards, &player_one_cardrows,
-                          &player_two_handcards, &player_two_chosencards, &player_two_cardrows) == 1)
+    if (phase == PHASE_CHOOSING)
     {
-      freePlayer(&player_one_handcards, &player_one_chosencards, &player_one_cardrows);
-      freePlayer(&player_two_handcards, &player_two_chosencards, &player_two_cardrows);
-      break_early = TRUE;
-      break;
+      printCardChoosingPhase();
+      long long phase_start_ns = STATS_NOW();
+      int choosing_error = cardChoosingPhase(players, players_count, &current_player);
+      STATS_ADD(choosing_phases_, 1);
+      STATS_ADD(choosing_phase_ns_, STATS_NOW() - phase_start_ns);
+      if (choosing_error == 1)
+      {
+        break_early = TRUE;
+        break;
+      }
+      passHandCards(players, players_count);
+      phase = PHASE_ACTION;
     }
-    exchangePlayerCards(&player_one_handcards, &player_two_handcards);
     printActionPhase();
-    if (actionChoosingPhase(&player_one_handcards, &player_one_chosencards, &player_one_cardrows,
-                            &player_two_handcards, &player_two_chosencards, &player_two_cardrows) == 1)
+    long long phase_start_ns = STATS_NOW();
+    int action_error = actionChoosingPhase(players, players_count, &current_player);
+    STATS_ADD(action_phases_, 1);
+    STATS_ADD(action_phase_ns_, STATS_NOW() - phase_start_ns);
+    if (action_error == 1)
     {
-      freePlayer(&player_one_handcards, &player_one_chosencards, &player_one_cardrows);
-      freePlayer(&player_two_handcards, &player_two_chosencards, &player_two_cardrows);
       break_early = TRUE;
       break;
     }
-  } while ((player_one_handcards != NULL || player_one_chosencards != NULL) &&
-           (player_two_handcards != NULL || player_two_chosencards != NULL));
+    phase = PHASE_CHOOSING;
+  } while (!isGameOver(players, players_count));
   if (!break_early)
   {
     printf("\n");
-    printPlayerPoints(argv[1], &player_one_cardrows, &player_two_cardrows);
-    freePlayer(&player_one_handcards, &player_one_chosencards, &player_one_cardrows);
-    freePlayer(&player_two_handcards, &player_two_chosencards, &player_two_cardrows);
+    // With a results journal the config file stays as it is, the result is written to the journal instead
+    int points[MAX_PLAYERS];
+    long long scoring_start_ns = STATS_NOW();
+    printPlayerPoints(options.journal_file_ == NULL ? options.config_file_ : NULL, players, players_count, points);
+    STATS_ADD(scoring_ns_, STATS_NOW() - scoring_start_ns);
+    JournalRecord record;
+    fillJournalRecord(&record, deck_hash, points, players_count, start_ns);
+    addJournalRecord(&results_journal, &results_journal.batch_, &record);
+  }
+  if (closeJournal(&results_journal) != 0)
+  {
+    printf(WARNING_JOURNAL_NOT_WRITTEN);
+  }
+  if (event_log.file_ != NULL)
+  {
+    writeEventLog(&players[0], &players[1], !break_early);
+  }
+  else if (options.log_file_ != NULL && options.load_file_ == NULL)
+  {
+    printf(WARNING_LOG_NOT_WRITTEN);
+  }
+  if (break_early && options.save_file_ != NULL)
+  {
+    unsigned char snapshot[SNAPSHOT_SIZE];
+    if (players_count != MIN_PLAYERS ||
+        saveSnapshot(&players[0], &players[1], phase, current_player, players_count, deck_hash, snapshot) != 0 ||
+        writeSnapshotFile(options.save_file_, snapshot) != 0)
+    {
+      printf(WARNING_GAME_NOT_SAVED);
+    }
+  }
+  // All cards live in the arena, so the lists of both players are released at once
+  freeCardArena(&arena);
+  freeOutputBuffer(&status_output);
+  freeInputReader(&player_input);
+  if (options.stats_)
+  {
+    printStats();
   }
   return 0;
 }
+#endif
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function converts a given string to an integer using the strtol function. It returns the converted integer if
-/// the conversion was successful and -1 otherwise. It also strips away whitespaces before the conversion.
+/// This function converts a given string to an integer. It returns the converted integer if the conversion was
+/// successful and -1 otherwise. Spaces and newlines are ignored wherever they appear in the string.
 ///
 /// @param str The string to convert
 ///
@@ -234,1556 +1311,7963 @@ int main(int argc, char *argv[])
 //
 int stringToInt(const char *str)
 {
-  // Strip out spaces and newlines
-  char sanitized_str[strlen(str) + 1];
-  int j = 0;
-  for (size_t i = 0; i < strlen(str); i++)
-  {
-    if (str[i] != ' ' && str[i] != '\n')
-    {
-      sanitized_str[j++] = str[i];
-    }
-  }
-  sanitized_str[j] = '\0';
-  char *endptr;
-  long value = strtol(sanitized_str, &endptr, 10);
-  // Check for conversion errors
-  if (*endptr != '\0' || value < INT_MIN || value > INT_MAX)
-  {
-    return -1;
-  }
-  return (int)value;
+  return parseInteger(str, str + strlen(str));
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This is a helper function to retrieve user input using malloc and realloc. It returns the inputted string or NULL
-/// if there was a memory allocation error.
+/// This function converts the characters from start to end to an integer in a single pass and without copying them.
+/// Spaces and newlines are skipped wherever they appear. The remaining characters are converted like strtol does it
+/// in base 10: leading whitespace and a sign are allowed, followed by at least one digit and nothing else. Characters
+/// that consist only of spaces and newlines are converted to 0.
+///
+/// @param start The first character to convert
+/// @param end The character after the last one to convert
 ///
 /// @return
-///      NULL if there was a memory allocation error
-///      the inputted string if there was no memory allocation error
+///      -1 if the conversion failed or the value does not fit into an int
+///      the converted integer if the conversion was successful
 //
-char* readInput()
+int parseInteger(const char *start, const char *end)
 {
-  size_t bufferSize = 10;
-  // Allocate initial buffer
-  char* buffer = (char*)malloc(bufferSize * sizeof(char));
-  if (buffer == NULL)
+  const char *cursor = start;
+  while (cursor < end && (*cursor == ' ' || *cursor == '\n'))
   {
-    return NULL;
+    cursor++;
+  }
+  if (cursor == end)
+  {
+    return 0;
+  }
+  while (cursor < end && isspace((unsigned char)*cursor))
+  {
+    cursor++;
+  }
+  int negative = FALSE;
+  if (cursor < end && (*cursor == '+' || *cursor == '-'))
+  {
+    negative = *cursor == '-';
+    cursor++;
   }
-  size_t index = 0;
-  int c;
-  // Read characters until newline or EOF is reached and reallocate buffer if necessary
-  while ((c = getchar()) != EOF && c != '\n')
+  long long value = 0;
+  int digits_count = 0;
+  for (; cursor < end; cursor++)
   {
-    if (index == bufferSize - 1)
+    if (isdigit((unsigned char)*cursor))
     {
-      bufferSize *= 2;
-      char* temp = (char*)realloc(buffer, bufferSize * sizeof(char));
-      if (temp == NULL)
+      // Once the value is out of range, further digits only have to be checked, not added
+      if (value <= (long long)INT_MAX + 1)
       {
-        free(buffer);
-        return NULL;
+        value = value * 10 + (*cursor - '0');
       }
-      buffer = temp;
+      digits_count++;
+    }
+    else if (*cursor != ' ' && *cursor != '\n')
+    {
+      return -1;
     }
-    buffer[index++] = (char)c;
   }
-  buffer[index] = '\0';
-  return buffer;
+  value = negative ? -value : value;
+  if (digits_count == 0 || value < INT_MIN || value > INT_MAX)
+  {
+    return -1;
+  }
+  return (int)value;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function prints the points of both players and the winner of the game to the console and writes the same
-/// information to the config file.
+/// This is a helper function to retrieve a line of user input. The input is read in large blocks into a buffer that
+/// grows with realloc and is reused for all lines, so no memory is allocated for a single line. The line does not
+/// contain the newline and stays valid until the next call. A last line without a newline is returned as well.
 ///
-/// @param config_file The path to the config file
-/// @param player_one_cardrows The row of cards from the first player
-/// @param player_two_cardrows The row of cards from the second player
+/// @param line Is set to the line that was read
 ///
-/// @return void
+/// @return
+///      0 if a line was read
+///      4 if there was a memory allocation error
+///      5 if there is no more input
 //
-void printPlayerPoints(char *config_file, Card ***player_one_cardrows, Card ***player_two_cardrows)
+int readInput(char **line)
 {
-  int player_one_points = calculatePlayerPoints(player_one_cardrows);
-  int player_two_points = calculatePlayerPoints(player_two_cardrows);
-  if (player_one_points < player_two_points)
+  InputReader *reader = &player_input;
+  char *newline = NULL;
+  while (TRUE)
   {
-    printf("Player 2: %i points\n", player_two_points);
-    printf("Player 1: %i points\n", player_one_points);
-    printf("\n");
-    printf(PlAYER_2_WINS);
+    size_t unscanned = reader->length_ - reader->start_ - reader->scanned_;
+    if (unscanned > 0)
+    {
+      newline = memchr(reader->buffer_ + reader->start_ + reader->scanned_, '\n', unscanned);
+    }
+    if (newline != NULL)
+    {
+      break;
+    }
+    reader->scanned_ = reader->length_ - reader->start_;
+    if (reader->end_of_input_)
+    {
+      if (reader->scanned_ == 0)
+      {
+        return END_OF_INPUT;
+      }
+      // The last line has no newline, the space behind it is always free for the null terminator
+      newline = reader->buffer_ + reader->length_;
+      break;
+    }
+    int error = fillInputReader(reader);
+    if (error != 0)
+    {
+      return error;
+    }
+  }
+  *newline = '\0';
+  *line = reader->buffer_ + reader->start_;
+  size_t line_end = newline - reader->buffer_;
+  reader->start_ = line_end < reader->length_ ? line_end + 1 : line_end;
+  reader->scanned_ = 0;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function reads the next block of input into the buffer of a reader. Lines that were already returned are
+/// dropped first and the buffer grows with realloc if a single line does not fit. Anything printed so far is flushed
+/// before, so a prompt is visible while the reader waits for input.
+///
+/// @param reader The reader to fill
+///
+/// @return
+///      0 if the buffer was filled or the end of the input was reached
+///      4 if there was a memory allocation error
+//
+int fillInputReader(InputReader *reader)
+{
+  if (reader->start_ > 0)
+  {
+    memmove(reader->buffer_, reader->buffer_ + reader->start_, reader->length_ - reader->start_);
+    reader->length_ -= reader->start_;
+    reader->start_ = 0;
+  }
+  // One byte always stays free for the null terminator of the last line
+  if (reader->capacity_ - reader->length_ < INPUT_READ_BLOCK_SIZE + 1)
+  {
+    size_t capacity = reader->capacity_ == 0 ? INPUT_READ_BLOCK_SIZE + 1 : reader->capacity_ * 2;
+    char *temp = realloc(reader->buffer_, capacity);
+    if (temp == NULL)
+    {
+      return MEMORY_ALLOCATION_ERROR;
+    }
+    reader->buffer_ = temp;
+    reader->capacity_ = capacity;
+  }
+  fflush(stdout);
+  ssize_t bytes_read;
+  do
+  {
+    bytes_read = read(reader->fd_, reader->buffer_ + reader->length_, reader->capacity_ - reader->length_ - 1);
+  } while (bytes_read < 0 && errno == EINTR);
+  if (bytes_read <= 0)
+  {
+    reader->end_of_input_ = TRUE;
+    return 0;
+  }
+  STATS_ADD(input_bytes_read_, bytes_read);
+  reader->length_ += bytes_read;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function frees the buffer of an input reader.
+///
+/// @param reader The reader to free
+///
+/// @return void
+//
+void freeInputReader(InputReader *reader)
+{
+  free(reader->buffer_);
+  reader->buffer_ = NULL;
+  reader->capacity_ = 0;
+  reader->start_ = 0;
+  reader->scanned_ = 0;
+  reader->length_ = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints the message of an invalid command to the console and counts it for the statistics.
+///
+/// @param message The message that explains why the command is invalid
+///
+/// @return void
+//
+void printInvalidCommand(const char *message)
+{
+  fputs(message, stdout);
+  STATS_INVALID_COMMAND(message);
+}
+
+#ifdef A3_STATS
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function counts an invalid command under the type of its message. Messages that are no known type of invalid
+/// command are not counted.
+///
+/// @param message The message that explains why the command is invalid
+///
+/// @return void
+//
+void countInvalidCommand(const char *message)
+{
+  for (int i = 0; i < INVALID_COMMAND_TYPES; i++)
+  {
+    if (message == INVALID_COMMAND_MESSAGES[i] || strcmp(message, INVALID_COMMAND_MESSAGES[i]) == 0)
+    {
+      stats.invalid_commands_[i]++;
+      return;
+    }
+  }
+}
+#endif
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function writes the statistics of the main thread as a JSON document to stderr, so the output of the game
+/// stays as it is. Without -DA3_STATS there are no statistics and a warning is printed instead.
+///
+/// @return void
+//
+void printStats(void)
+{
+#ifdef A3_STATS
+  fprintf(stderr, "{\n  \"cards\": {\"allocated\": %lld, \"freed\": %lld},\n", stats.cards_allocated_,
+          stats.cards_freed_);
+  fprintf(stderr, "  \"nodes_visited\": {\"getCardFromHand\": %lld, \"getCardFromChosen\": %lld, "
+          "\"addCardToRow\": %lld},\n", stats.hand_nodes_visited_, stats.chosen_nodes_visited_,
+          stats.row_nodes_visited_);
+  fprintf(stderr, "  \"input_bytes_read\": %lld,\n  \"invalid_commands\": {", stats.input_bytes_read_);
+  for (int i = 0; i < INVALID_COMMAND_TYPES; i++)
+  {
+    fprintf(stderr, "%s\"%s\": %lld", i > 0 ? ", " : "", INVALID_COMMAND_NAMES[i], stats.invalid_commands_[i]);
+  }
+  fprintf(stderr, "},\n  \"phases\": {\n");
+  fprintf(stderr, "    \"cardChoosingPhase\": {\"count\": %lld, \"wall_time_ns\": %lld},\n", stats.choosing_phases_,
+          stats.choosing_phase_ns_);
+  fprintf(stderr, "    \"actionChoosingPhase\": {\"count\": %lld, \"wall_time_ns\": %lld},\n", stats.action_phases_,
+          stats.action_phase_ns_);
+  fprintf(stderr, "    \"scoring\": {\"wall_time_ns\": %lld}\n  }\n}\n", stats.scoring_ns_);
+#else
+  printf(WARNING_STATS_NOT_COMPILED);
+#endif
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints the points of all players and the winners of the game to the console and writes the same
+/// information to the config file, unless no config file is given.
+///
+/// @param config_file The path to the config file or NULL
+/// @param players The players of the game
+/// @param players_count The number of players
+/// @param points Output parameter for the points of the players
+///
+/// @return void
+//
+void printPlayerPoints(char *config_file, const Player *players, int players_count, int *points)
+{
+  for (int i = 0; i < players_count; i++)
+  {
+    points[i] = calculatePlayerPoints(players[i].cardrows_);
+  }
+  renderPlayerPoints(&status_output, points, players_count);
+  flushOutputBuffer(&status_output, stdout);
+  if (config_file != NULL)
+  {
+    writePlayerPointsToFile(config_file, points, players_count);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function renders the points of all players and the winners of the game into an output buffer. The players are
+/// sorted by their points, players with the same points keep the order of their ids. Every player with the most points
+/// wins the game.
+///
+/// @param buffer The buffer to render into
+/// @param points The points of the players, indexed like the players
+/// @param players_count The number of players
+///
+/// @return void
+//
+void renderPlayerPoints(OutputBuffer *buffer, const int *points, int players_count)
+{
+  PlayerRank ranks[MAX_PLAYERS];
+  for (int i = 0; i < players_count; i++)
+  {
+    ranks[i].points_ = points[i];
+    ranks[i].index_ = i;
+  }
+  qsort(ranks, players_count, sizeof(PlayerRank), comparePlayerRanks);
+  for (int i = 0; i < players_count; i++)
+  {
+    appendFormatted(buffer, "Player %i: %i points\n", ranks[i].index_ + 1, ranks[i].points_);
+  }
+  appendToOutputBuffer(buffer, "\n", 1);
+  for (int i = 0; i < players_count && ranks[i].points_ == ranks[0].points_; i++)
+  {
+    appendFormatted(buffer, PLAYER_WINS, ranks[i].index_ + 1);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function for qsort that orders the ranks of two players. More points come first, on equal points the
+/// player with the lower index comes first.
+///
+/// @param first The first rank
+/// @param second The second rank
+///
+/// @return
+///      a negative value if the first rank comes first
+///      a positive value if the second rank comes first
+//
+int comparePlayerRanks(const void *first, const void *second)
+{
+  const PlayerRank *first_rank = first;
+  const PlayerRank *second_rank = second;
+  if (first_rank->points_ != second_rank->points_)
+  {
+    return first_rank->points_ > second_rank->points_ ? -1 : 1;
+  }
+  return first_rank->index_ - second_rank->index_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function writes the points of all players and the winners of the game to the config file, in the same format
+/// they are printed to the console. If the file could not be opened, it prints a warning to the console.
+///
+/// @param config_file The path to the config file
+/// @param points The points of the players, indexed like the players
+/// @param players_count The number of players
+///
+/// @return void
+//
+void writePlayerPointsToFile(char *config_file, const int *points, int players_count)
+{
+  FILE *file = fopen(config_file, "a"); // append mode
+  if (file == NULL)
+  {
+    printf(WARNING_FILE_NOT_WRITTEN);
+    return; // Exit code 0
+  }
+  OutputBuffer results = {NULL, 0, 0};
+  appendToOutputBuffer(&results, "\n", 1);
+  renderPlayerPoints(&results, points, players_count);
+  flushOutputBuffer(&results, file);
+  freeOutputBuffer(&results);
+  fclose(file);
+  file = NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function parses the command line arguments. Exactly one config file path must be given, it can be combined
+/// with the options --simulate <games>, --strategy <name>, --quiet, --bot, --bot-time <milliseconds>, --solve,
+/// --log <file>, --replay <file>, --save <file>, --load <file>, --serve <port or socket path>, --journal <file>,
+/// --journal-sync <milliseconds> and --stats. The strategy option can be given once for each player. With
+/// --journal-summary <file> no config file is needed, neither with --tournament <deck list>, which can be combined with
+/// --tournament-games <games> and takes any number of strategy options up to MAX_STRATEGY_OPTIONS. Strategy plugins are
+/// loaded with --plugin <shared object> and can be selected with --strategy. An opening book is mapped with
+/// --book <file> and built with --build-book <file> and --book-games <games>.
+///
+/// @param argc The number of arguments. Same name as the main file argument.
+/// @param argv The arguments. Same name as the main file argument.
+/// @param options Output parameter for the parsed options
+///
+/// @return
+///      0 if the arguments are valid
+///      1 if the arguments are invalid
+//
+int parseArguments(int argc, char *argv[], Options *options)
+{
+  options->config_file_ = NULL;
+  options->simulate_games_ = 0;
+  options->quiet_ = FALSE;
+  options->bot_ = FALSE;
+  options->search_time_ms_ = DEFAULT_SEARCH_TIME_MS;
+  options->solve_ = FALSE;
+  options->log_file_ = NULL;
+  options->replay_file_ = NULL;
+  options->save_file_ = NULL;
+  options->load_file_ = NULL;
+  options->serve_address_ = NULL;
+  options->journal_file_ = NULL;
+  options->journal_sync_ms_ = DEFAULT_JOURNAL_SYNC_MS;
+  options->journal_summary_file_ = NULL;
+  options->stats_ = FALSE;
+  options->tournament_file_ = NULL;
+  options->tournament_games_ = 1;
+  options->book_file_ = NULL;
+  options->build_book_file_ = NULL;
+  options->book_games_ = DEFAULT_BOOK_GAMES;
+  options->strategies_[0] = &STRATEGIES[0];
+  options->strategies_[1] = &STRATEGIES[0];
+  // Strategies are looked up after all plugins are loaded, so a plugin can be given after the strategy option
+  const char *strategy_names[MAX_STRATEGY_OPTIONS];
+  int strategies_count = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], SIMULATE_OPTION) == 0 && i + 1 < argc)
+    {
+      char *endptr;
+      options->simulate_games_ = strtol(argv[++i], &endptr, 10);
+      if (*endptr != '\0' || options->simulate_games_ <= 0)
+      {
+        printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+        return 1;
+      }
+    }
+    else if (strcmp(argv[i], STRATEGY_OPTION) == 0 && i + 1 < argc && strategies_count < MAX_STRATEGY_OPTIONS)
+    {
+      strategy_names[strategies_count++] = argv[++i];
+    }
+    else if (strcmp(argv[i], PLUGIN_OPTION) == 0 && i + 1 < argc)
+    {
+      if (loadStrategyPlugin(argv[++i]) != 0)
+      {
+        return 1;
+      }
+    }
+    else if (strcmp(argv[i], QUIET_OPTION) == 0)
+    {
+      options->quiet_ = TRUE;
+    }
+    else if (strcmp(argv[i], BOT_OPTION) == 0)
+    {
+      options->bot_ = TRUE;
+    }
+    else if (strcmp(argv[i], SOLVE_OPTION) == 0)
+    {
+      options->solve_ = TRUE;
+    }
+    else if (strcmp(argv[i], STATS_OPTION) == 0)
+    {
+      options->stats_ = TRUE;
+    }
+    else if (strcmp(argv[i], LOG_OPTION) == 0 && i + 1 < argc)
+    {
+      options->log_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], REPLAY_OPTION) == 0 && i + 1 < argc)
+    {
+      options->replay_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], SAVE_OPTION) == 0 && i + 1 < argc)
+    {
+      options->save_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], LOAD_OPTION) == 0 && i + 1 < argc)
+    {
+      options->load_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], SERVE_OPTION) == 0 && i + 1 < argc)
+    {
+      options->serve_address_ = argv[++i];
+    }
+    else if (strcmp(argv[i], JOURNAL_OPTION) == 0 && i + 1 < argc)
+    {
+      options->journal_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], JOURNAL_SYNC_OPTION) == 0 && i + 1 < argc)
+    {
+      char *endptr;
+      options->journal_sync_ms_ = strtol(argv[++i], &endptr, 10);
+      if (*endptr != '\0' || options->journal_sync_ms_ < 0 || options->journal_sync_ms_ > MAX_JOURNAL_SYNC_MS)
+      {
+        printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+        return 1;
+      }
+    }
+    else if (strcmp(argv[i], JOURNAL_SUMMARY_OPTION) == 0 && i + 1 < argc)
+    {
+      options->journal_summary_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], TOURNAMENT_OPTION) == 0 && i + 1 < argc)
+    {
+      options->tournament_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], BOOK_OPTION) == 0 && i + 1 < argc)
+    {
+      options->book_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], BUILD_BOOK_OPTION) == 0 && i + 1 < argc)
+    {
+      options->build_book_file_ = argv[++i];
+    }
+    else if (strcmp(argv[i], BOOK_GAMES_OPTION) == 0 && i + 1 < argc)
+    {
+      char *endptr;
+      options->book_games_ = strtol(argv[++i], &endptr, 10);
+      if (*endptr != '\0' || options->book_games_ <= 0 || options->book_games_ > MAX_BOOK_GAMES)
+      {
+        printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+        return 1;
+      }
+    }
+    else if (strcmp(argv[i], TOURNAMENT_GAMES_OPTION) == 0 && i + 1 < argc)
+    {
+      char *endptr;
+      options->tournament_games_ = strtol(argv[++i], &endptr, 10);
+      if (*endptr != '\0' || options->tournament_games_ <= 0)
+      {
+        printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+        return 1;
+      }
+    }
+    else if (strcmp(argv[i], BOT_TIME_OPTION) == 0 && i + 1 < argc)
+    {
+      char *endptr;
+      options->search_time_ms_ = strtol(argv[++i], &endptr, 10);
+      if (*endptr != '\0' || options->search_time_ms_ < 0 || options->search_time_ms_ > MAX_SEARCH_TIME_MS)
+      {
+        printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+        return 1;
+      }
+    }
+    else if (strncmp(argv[i], "--", 2) != 0 && options->config_file_ == NULL)
+    {
+      options->config_file_ = argv[i];
+    }
+    else
+    {
+      printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+      return 1;
+    }
+  }
+  // A tournament takes its decks from the deck list, the other modes play two strategies against each other
+  if ((options->config_file_ == NULL && options->journal_summary_file_ == NULL && options->tournament_file_ == NULL) ||
+      (options->tournament_file_ == NULL && strategies_count > 2))
+  {
+    printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+    return 1;
+  }
+  for (int i = 0; i < strategies_count; i++)
+  {
+    options->strategies_[i] = findStrategy(strategy_names[i]);
+    if (options->strategies_[i] == NULL)
+    {
+      printf("Error: Unknown strategy: %s\n", strategy_names[i]);
+      return 1;
+    }
+  }
+  options->strategies_count_ = strategies_count;
+  // A single strategy is used by both players
+  if (strategies_count == 1)
+  {
+    options->strategies_[1] = options->strategies_[0];
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function opens a file and returns a pointer to it. The file is open in read-only mode.
+///
+/// @param config_file The path to the config file
+///
+/// @return
+///      NULL if the file could not be opened
+///      file pointer if the file could be opened
+//
+FILE *openFile(char *config_file)
+{
+  FILE *file = fopen(config_file, "r");
+  if (file == NULL)
+  {
+    printf("Error: Cannot open file: %s\n", config_file);
+    return NULL;
+  }
+  return file;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function loads the config file in a single pass. The file is opened once and read in large blocks, then the
+/// magic number is checked, the number of players is parsed and the players are initialized. The file holds
+/// HAND_SIZE cards for every player, they are created and dealt round-robin in the order they appear in the file, so
+/// the first card goes to the first player, the second card to the second player and so on. Instead of the cards the
+/// third line can hold a seed (e.g. "SEED 123456"), then the deck is generated from the seed and the same seed always
+/// deals the same cards. A card line that is not a valid card or whose value is not from 1 to MAX_CARD_VALUE makes the
+/// file invalid, and so does a value that is dealt twice to one player, as a card is chosen by its value. Finally the
+/// hand cards of every player are sorted.
+///
+/// @param config_file The path to the config file
+/// @param arena The arena the cards are created in, it has to hold HAND_SIZE cards for every player
+/// @param players_count Output parameter for the number of players
+/// @param players The players, they are initialized and receive their hand cards
+/// @param max_players_count The largest number of players the caller supports, a larger table has its own error
+///
+/// @return
+///      0 if the config file was loaded successfully
+///      2 if the config file could not be opened
+///      3 if the config file is invalid or has more players than the caller supports
+///      4 if there was a memory allocation error
+//
+int loadConfigFile(char *config_file, CardArena *arena, int *players_count, Player *players, int max_players_count)
+{
+  FILE *file = openFile(config_file);
+  if (file == NULL)
+  {
+    return CANNOT_OPEN_FILE;
+  }
+  size_t length = 0;
+  char *content = readConfigFile(file, NULL, 0, CONFIG_CARDS_LINE_START - 1, &length);
+  if (content == NULL)
+  {
+    fclose(file);
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  char *cursor = content;
+  char *line = nextConfigLine(&cursor, content + length);
+  if (line == NULL || strcmp(line, CONFIG_MAGIC_NUMBER) != 0)
+  {
+    printf("Error: Invalid file: %s\n", config_file);
+    fclose(file);
+    free(content);
+    return INVALID_FILE;
+  }
+  // The number of players is defined in the second line of the file
+  line = nextConfigLine(&cursor, content + length);
+  *players_count = line != NULL ? stringToInt(line) : -1;
+  if (*players_count < MIN_PLAYERS || *players_count > MAX_PLAYERS)
+  {
+    printf("Error: Invalid file: %s\n", config_file);
+    fclose(file);
+    free(content);
+    return INVALID_FILE;
+  }
+  // A valid table that is larger than the caller supports is not reported as an invalid file
+  if (*players_count > max_players_count)
+  {
+    printf(PLAYERS_NOT_SUPPORTED, max_players_count, config_file);
+    fclose(file);
+    free(content);
+    return INVALID_FILE;
+  }
+  // Only the card lines of the players that play are read, the buffer may move while it grows
+  size_t header_length = cursor - content;
+  content = readConfigFile(file, content, header_length, *players_count * HAND_SIZE, &length);
+  fclose(file);
+  file = NULL;
+  if (content == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  cursor = content + header_length;
+  const char *end = content + length;
+  // A seed line replaces the card lines, the deck is then generated from the seed
+  uint64_t seed = 0;
+  line = nextConfigLine(&cursor, end);
+  if (line != NULL && parseDeckSeed(line, &seed))
+  {
+    free(content);
+    return generateDeck(arena, seed, *players_count, players);
+  }
+  // Keep track of the last hand card of each player, so that dealing a card is a constant time append
+  Card *player_last_cards[MAX_PLAYERS];
+  for (int i = 0; i < *players_count; i++)
+  {
+    initPlayer(&players[i], i + 1);
+    player_last_cards[i] = NULL;
+  }
+  int cards_count = *players_count * HAND_SIZE;
+  for (int i = 0; i < cards_count; i++)
+  {
+    // The first card line was already read to look for a seed
+    line = i > 0 ? nextConfigLine(&cursor, end) : line;
+    if (line == NULL)
+    {
+      printf("Error: Invalid file: %s\n", config_file);
+      free(content);
+      return INVALID_FILE;
+    }
+    Card *temp_card = NULL;
+    int card_error = createCard(arena, line, &temp_card);
+    if (card_error == MEMORY_ALLOCATION_ERROR)
+    {
+      free(content);
+      return MEMORY_ALLOCATION_ERROR;
+    }
+    // A card is chosen by its value, so a value may appear only once in a hand
+    if (card_error != 0 || temp_card->value_ < 1 || temp_card->value_ > MAX_CARD_VALUE ||
+        isInCardSet(&players[i % *players_count].handset_, temp_card->value_))
+    {
+      printf("Error: Invalid file: %s\n", config_file);
+      free(content);
+      return INVALID_FILE;
+    }
+    dealCard(&players[i % *players_count], &player_last_cards[i % *players_count], temp_card);
+  }
+  free(content);
+  sortHandCards(players, *players_count);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function generates a deck from a seed and deals it like the cards of a config file, round-robin starting with
+/// the first player. The cards are drawn by createRandomCard, so the same seed always deals the same cards.
+///
+/// @param arena The arena the cards are created in, it has to hold HAND_SIZE cards for every player
+/// @param seed The seed of the deck
+/// @param players_count The number of players
+/// @param players The players, they are initialized and receive their hand cards
+///
+/// @return
+///      0 if the deck was generated successfully
+///      4 if there was a memory allocation error
+//
+int generateDeck(CardArena *arena, uint64_t seed, int players_count, Player *players)
+{
+  Card *player_last_cards[MAX_PLAYERS];
+  for (int i = 0; i < players_count; i++)
+  {
+    initPlayer(&players[i], i + 1);
+    player_last_cards[i] = NULL;
+  }
+  uint64_t random_state = seed;
+  int values[MAX_CARD_VALUE];
+  int values_left = 0;
+  for (int i = 0; i < players_count * HAND_SIZE; i++)
+  {
+    Card *temp_card = createRandomCard(arena, &random_state, values, &values_left,
+                                       &players[i % players_count].handset_);
+    if (temp_card == NULL)
+    {
+      return MEMORY_ALLOCATION_ERROR;
+    }
+    dealCard(&players[i % players_count], &player_last_cards[i % players_count], temp_card);
+  }
+  sortHandCards(players, players_count);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function appends a card to the hand cards of a player while a deck is dealt.
+///
+/// @param player The player that receives the card
+/// @param last_card The last hand card of the player, it is updated to the dealt card
+/// @param card The card to deal
+///
+/// @return void
+//
+void dealCard(Player *player, Card **last_card, Card *card)
+{
+  if (*last_card == NULL)
+  {
+    player->handcards_ = card;
+  }
+  else
+  {
+    (*last_card)->next_ = card;
+  }
+  *last_card = card;
+  indexHandCard(player, card);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function sorts the hand cards of all players after a deck was dealt. Sorting relinks the cards, so the hand
+/// card index of every player stays valid.
+///
+/// @param players The players
+/// @param players_count The number of players
+///
+/// @return void
+//
+void sortHandCards(Player *players, int players_count)
+{
+  for (int i = 0; i < players_count; i++)
+  {
+    sortCards(&players[i].handcards_);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to read the beginning of a file into one heap buffer. It reads the file in large blocks and stops
+/// as soon as the buffer holds the given number of lines, so results appended to the end of a config file are never
+/// read. A buffer that was returned before can be continued, then only the lines from the given start on are counted,
+/// so the lines before it may already be split. The buffer grows with realloc and is always null terminated.
+///
+/// @param file The file to read from
+/// @param content A buffer returned by an earlier call that is continued, or NULL to start a new one
+/// @param start The offset in the buffer from which the lines are counted
+/// @param lines_count The number of lines that are needed from the start on
+/// @param length The number of bytes in the buffer, it is updated to the number of bytes read
+///
+/// @return
+///      NULL if there was a memory allocation error, a continued buffer is freed then
+///      a pointer to the buffer if there was no memory allocation error
+//
+char *readConfigFile(FILE *file, char *content, size_t start, int lines_count, size_t *length)
+{
+  // A buffer of this function always has room for at least one block
+  size_t capacity = content != NULL && *length > CONFIG_READ_BLOCK_SIZE ? *length : CONFIG_READ_BLOCK_SIZE;
+  if (content == NULL)
+  {
+    content = malloc(capacity + 1); // +1 for the null terminator
+    *length = 0;
+    if (content == NULL)
+    {
+      return NULL;
+    }
+  }
+  int newlines_count = 0;
+  for (const char *newline = content + start; (newline = memchr(newline, '\n', content + *length - newline)) != NULL;
+       newline++)
+  {
+    newlines_count++;
+  }
+  while (newlines_count < lines_count)
+  {
+    if (*length == capacity)
+    {
+      capacity *= 2;
+      char *temp = realloc(content, capacity + 1);
+      if (temp == NULL)
+      {
+        free(content);
+        return NULL;
+      }
+      content = temp;
+    }
+    size_t read = fread(content + *length, 1, capacity - *length, file);
+    if (read == 0)
+    {
+      break;
+    }
+    // Count the newlines in the block that was just read
+    const char *newline = content + *length;
+    const char *block_end = content + *length + read;
+    while ((newline = memchr(newline, '\n', block_end - newline)) != NULL)
+    {
+      newlines_count++;
+      newline++;
+    }
+    *length += read;
+  }
+  content[*length] = '\0';
+  return content;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to split the next line off a buffer that was read by readConfigFile. The newline at the end of the
+/// line is replaced with a null terminator in place and the cursor is moved to the beginning of the following line.
+///
+/// @param cursor A pointer to the current position in the buffer
+/// @param end The end of the buffer
+///
+/// @return
+///      NULL if there are no lines left
+///      a pointer to the null terminated line otherwise
+//
+char *nextConfigLine(char **cursor, const char *end)
+{
+  if (*cursor >= end)
+  {
+    return NULL;
+  }
+  char *line = *cursor;
+  char *newline = memchr(line, '\n', end - line);
+  if (newline == NULL)
+  {
+    *cursor = (char *)end;
+  }
+  else
+  {
+    *newline = '\0';
+    *cursor = newline + 1;
+  }
+  return line;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints a welcome message to the console.
+///
+/// @param players_count The number of players
+///
+/// @return void
+//
+void printWelcomeMessage(int players_count)
+{
+  printf(WELCOME_MESSAGE, players_count);
+  printf("\n");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function parses a string and returns the corresponding color for the creation of a Card.
+///
+/// @param color The string to parse
+///
+/// @return
+///      RED if the string is "r"
+///      GREEN if the string is "g"
+///      BLUE if the string is "b"
+///      WHITE if the string is "w"
+///      '\0' if the string is invalid
+//
+Color parseColor(char *color)
+{
+  // A color is a single character that is worth points
+  unsigned char character = (unsigned char)color[0];
+  if (character != '\0' && color[1] == '\0' && CARD_COLOR_POINTS[character] != 0)
+  {
+    return (Color)character;
+  }
+  printf("Error: Invalid color: %s\n", color);
+  return '\0';
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function creates a card from a line in the config file. It parses the value and the color from the string
+/// and returns a Card from it. The line must consist of a number and a valid color separated by an underscore. The
+/// Card is taken from the given arena.
+///
+/// @param arena The arena to take the card from
+/// @param config_file_line The line from the config file
+/// @param card Output parameter for the card
+///
+/// @return
+///      0 if the card was created
+///      3 if the line is not a valid card
+///      4 if there was a memory allocation error
+//
+int createCard(CardArena *arena, char *config_file_line, Card **card)
+{
+  *card = NULL;
+  char *value_token = strtok(config_file_line, "_");
+  char *color = strtok(NULL, "_");
+  if (value_token == NULL || color == NULL || strtok(NULL, "_") != NULL)
+  {
+    return INVALID_FILE;
+  }
+  int value = stringToInt(value_token);
+  color[strcspn(color, "\n")] = 0;
+  Color parsed_color = parseColor(color);
+  if (value < 0 || parsed_color == '\0')
+  {
+    return INVALID_FILE;
+  }
+  *card = allocateCard(arena);
+  if (*card == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  (*card)->color_ = parsed_color;
+  (*card)->value_ = value;
+  (*card)->next_ = NULL;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function parses a seed line of a config file. The line consists of the seed prefix followed by a decimal
+/// number, anything else is not a seed line.
+///
+/// @param line The line from the config file
+/// @param seed Output parameter for the seed
+///
+/// @return
+///      TRUE if the line is a seed line
+///      FALSE if the line is not a seed line
+//
+int parseDeckSeed(const char *line, uint64_t *seed)
+{
+  size_t prefix_length = strlen(CONFIG_SEED_PREFIX);
+  if (strncmp(line, CONFIG_SEED_PREFIX, prefix_length) != 0 || !isdigit((unsigned char)line[prefix_length]))
+  {
+    return FALSE;
+  }
+  char *end = NULL;
+  errno = 0;
+  unsigned long long value = strtoull(line + prefix_length, &end, 10);
+  if (errno != 0 || *end != '\0')
+  {
+    return FALSE;
+  }
+  *seed = (uint64_t)value;
+  return TRUE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function creates a card with a random value and a random color. The values are drawn without replacement with
+/// a lazy Fisher-Yates shuffle from all values 1 to MAX_CARD_VALUE, so a deck of up to MAX_CARD_VALUE cards has unique
+/// values. When all values are drawn, a new set of values is started for larger tables. Values that are excluded are
+/// skipped, so the hand a card is dealt to never holds a value twice, even though values repeat in larger tables. The
+/// Card is taken from the given arena.
+///
+/// @param arena The arena to take the card from
+/// @param random_state The state of the random number generator
+/// @param values The values that were not drawn yet, it has to hold MAX_CARD_VALUE values
+/// @param values_left The number of values that were not drawn yet, 0 starts a new set of values
+/// @param excluded The values that must not be drawn
+///
+/// @return
+///      NULL if the card could not be created
+///      a pointer to the card if the card could be created
+//
+Card *createRandomCard(CardArena *arena, uint64_t *random_state, int *values, int *values_left,
+                       const CardSet *excluded)
+{
+  Card *card = allocateCard(arena);
+  if (card == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return NULL;
+  }
+  int drawn = -1;
+  while (drawn < 0)
+  {
+    if (*values_left == 0)
+    {
+      for (int i = 0; i < MAX_CARD_VALUE; i++)
+      {
+        values[i] = i + 1;
+      }
+      *values_left = MAX_CARD_VALUE;
+    }
+    // An excluded value is passed over for the next value that is left, so a deck without repeated values draws
+    // exactly the same cards as if nothing was excluded
+    int start = randomBelow(random_state, *values_left);
+    for (int i = 0; i < *values_left && drawn < 0; i++)
+    {
+      int candidate = (start + i) % *values_left;
+      drawn = isInCardSet(excluded, values[candidate]) ? -1 : candidate;
+    }
+    if (drawn < 0)
+    {
+      // Every value that is left is excluded, so a new set of values is started
+      *values_left = 0;
+    }
+  }
+  // Swap the drawn value to the end of the values that are left, so it is not drawn again
+  (*values_left)--;
+  card->value_ = values[drawn];
+  values[drawn] = values[*values_left];
+  values[*values_left] = card->value_;
+  card->color_ = CARD_COLORS[randomBelow(random_state, COLORS_COUNT)];
+  card->next_ = NULL;
+  return card;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function initializes an arena for cards. All cards of a game are stored in one heap block, so they are created
+/// without a malloc each and all of them are released at once by freeCardArena.
+///
+/// @param arena The arena to initialize
+/// @param capacity The number of cards the arena can hold
+///
+/// @return
+///      0 if the arena could be initialized
+///      4 if there was a memory allocation error
+//
+int initCardArena(CardArena *arena, int capacity)
+{
+  arena->cards_ = malloc(sizeof(Card) * capacity);
+  arena->capacity_ = arena->cards_ != NULL ? capacity : 0;
+  arena->used_ = 0;
+  return arena->cards_ != NULL ? 0 : MEMORY_ALLOCATION_ERROR;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function resets an arena, so that its memory can be reused for the cards of the next game. All cards taken
+/// from the arena before become invalid.
+///
+/// @param arena The arena to reset
+///
+/// @return void
+//
+void resetCardArena(CardArena *arena)
+{
+  arena->used_ = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function frees an arena together with all cards taken from it.
+///
+/// @param arena The arena to free
+///
+/// @return void
+//
+void freeCardArena(CardArena *arena)
+{
+  STATS_ADD(cards_freed_, arena->used_);
+  free(arena->cards_);
+  arena->cards_ = NULL;
+  arena->capacity_ = 0;
+  arena->used_ = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function takes the next unused card from an arena.
+///
+/// @param arena The arena to take the card from
+///
+/// @return
+///      NULL if the arena is full
+///      a pointer to the card otherwise
+//
+Card *allocateCard(CardArena *arena)
+{
+  if (arena->used_ >= arena->capacity_)
+  {
+    return NULL;
+  }
+  STATS_ADD(cards_allocated_, 1);
+  return &arena->cards_[arena->used_++];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function adds a value to a card set. Values outside of the range of the set are ignored.
+///
+/// @param set The set to add the value to
+/// @param value The card value to add
+///
+/// @return void
+//
+void addToCardSet(CardSet *set, int value)
+{
+  if (value >= 0 && value < CARD_SET_SIZE)
+  {
+    set->words_[value / 64] |= (uint64_t)1 << (value % 64);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function removes a value from a card set. Values outside of the range of the set are ignored.
+///
+/// @param set The set to remove the value from
+/// @param value The card value to remove
+///
+/// @return void
+//
+void removeFromCardSet(CardSet *set, int value)
+{
+  if (value >= 0 && value < CARD_SET_SIZE)
+  {
+    set->words_[value / 64] &= ~((uint64_t)1 << (value % 64));
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks if a value is in a card set.
+///
+/// @param set The set to check
+/// @param value The card value to look for
+///
+/// @return
+///      TRUE if the value is in the set
+///      FALSE if the value is not in the set or outside of the range of the set
+//
+int isInCardSet(const CardSet *set, int value)
+{
+  if (value < 0 || value >= CARD_SET_SIZE)
+  {
+    return FALSE;
+  }
+  return (set->words_[value / 64] >> (value % 64)) & 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function exchanges the hand cards of the two players.
+///
+/// @param player_one The first player
+/// @param player_two The second player
+///
+/// @return
+///      0 if the cards could be exchanged successfully
+//
+int exchangePlayerCards(Player *player_one, Player *player_two)
+{
+  Card *temp_hand_cards = player_one->handcards_;
+  player_one->handcards_ = player_two->handcards_;
+  player_two->handcards_ = temp_hand_cards;
+  indexHandCards(player_one);
+  indexHandCards(player_two);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function passes the hand cards of every player to the next player of the ring, the last player passes them to
+/// the first one. Only the list heads move, the cards themselves are not touched. Every player then indexes the hand
+/// he received, so a round costs the size of a hand per player. With two players this is the same as exchanging the
+/// hand cards.
+///
+/// @param players The players of the ring
+/// @param players_count The number of players
+///
+/// @return void
+//
+void passHandCards(Player *players, int players_count)
+{
+  Card *last_handcards = players[players_count - 1].handcards_;
+  for (int i = players_count - 1; i > 0; i--)
+  {
+    players[i].handcards_ = players[i - 1].handcards_;
+  }
+  players[0].handcards_ = last_handcards;
+  for (int i = 0; i < players_count; i++)
+  {
+    indexHandCards(&players[i]);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints the card choosing phase text to the console.
+///
+/// @return void
+//
+void printCardChoosingPhase()
+{
+  printf(CARD_CHOOSING_PHASE_TITLE);
+  printf("\n");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints the action phase text to the console.
+///
+/// @return void
+//
+void printActionPhase()
+{
+  printf(ACTION_PHASE_TITLE);
+  printf("\n");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function performs the card choosing phase. It starts with the first player and lets them choose two cards from
+/// their hand cards and add them to their chosen cards. Then it does the same for every following player. It returns
+/// 0 if the card choosing phase could be performed successfully and 1 otherwise. The phase can be continued at any
+/// player, and a player that has already chosen a card only chooses the rest, so a saved game continues where it
+/// stopped. The opponent of a player is the next player of the ring, who receives the remaining hand cards.
+///
+/// @param players The players of the game
+/// @param players_count The number of players
+/// @param current_player The index of the player that chooses next, it is left at the player that stopped the phase
+///
+/// @return
+///      0 if the card choosing phase could be performed successfully
+///      1 if the card choosing phase could not be performed successfully
+//
+int cardChoosingPhase(Player *players, int players_count, int *current_player)
+{
+  for (; *current_player < players_count; (*current_player)++)
+  {
+    Player *player = &players[*current_player];
+    printPlayer(player);
+    while (countCards(player->chosencards_) < CARDS_TO_KEEP && player->handcards_ != NULL)
+    {
+      printf(player->chosencards_ == NULL ? PROMPT_CHOOSE_FIRST_CARD : PROMPT_CHOOSE_SECOND_CARD);
+      if (chooseCardToKeep(player, &players[(*current_player + 1) % players_count]) == 1)
+      {
+        return 1;
+      }
+    }
+    printf("\n");
+  }
+  *current_player = 0;
+  printf(CHOOSING_PHASE_IS_OVER);
+  printf("\n");
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints the details of a player to the console. It prints the hand cards, the chosen cards and the card
+/// rows of the player. The status is rendered into a reusable buffer first and then written at once. In quiet mode
+/// nothing is printed.
+///
+/// @param player The player to print
+///
+/// @return void
+//
+void printPlayer(const Player *player)
+{
+  if (quiet_mode)
+  {
+    return;
+  }
+  renderPlayer(&status_output, player);
+  flushOutputBuffer(&status_output, stdout);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function renders the details of a player into an output buffer, in the same format printPlayer prints them.
+///
+/// @param buffer The buffer to render into
+/// @param player The player to render
+///
+/// @return void
+//
+void renderPlayer(OutputBuffer *buffer, const Player *player)
+{
+  char header[32];
+  int length = snprintf(header, sizeof(header), "Player %i:\n", player->id_);
+  appendToOutputBuffer(buffer, header, length);
+  renderPlayerHandCards(buffer, &player->handcards_);
+  renderPlayerChosenCards(buffer, &player->chosencards_);
+  renderPlayerCardRows(buffer, player->cardrows_);
+  appendToOutputBuffer(buffer, "\n", 1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to render the card on each row of a player. It will render nothing, if the row is empty.
+///
+/// @param buffer The buffer to render into
+/// @param player_cardrows The card rows of the player
+///
+/// @return void
+//
+void renderPlayerCardRows(OutputBuffer *buffer, const CardRow *player_cardrows)
+{
+  char label[16];
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    Card *head = player_cardrows[i].head_;
+    if (head != NULL && head->color_ != '\0')
+    {
+      int length = snprintf(label, sizeof(label), "  row_%i: ", i + 1);
+      appendToOutputBuffer(buffer, label, length);
+      for (; head != NULL; head = head->next_)
+      {
+        appendCardLabel(buffer, head, head->next_ != NULL ? ' ' : '\n');
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to render all the chosen cards of a player. It will render just the label "chosen cards:" if the
+/// player has no chosen cards.
+///
+/// @param buffer The buffer to render into
+/// @param player_chosencards The chosen cards of the player
+///
+/// @return void
+//
+void renderPlayerChosenCards(OutputBuffer *buffer, Card *const *player_chosencards)
+{
+  Card *head = *player_chosencards;
+  if (head != NULL && head->color_ != '\0')
+  {
+    appendToOutputBuffer(buffer, "  chosen cards: ", 16);
+  }
+  else
+  {
+    appendToOutputBuffer(buffer, "  chosen cards:\n", 16);
+  }
+  for (; head != NULL && head->color_ != '\0'; head = head->next_)
+  {
+    appendCardLabel(buffer, head, head->next_ != NULL ? ' ' : '\n');
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to render all the hand cards of a player. It will render just the label "hand cards:" if the
+/// player has no hand cards.
+///
+/// @param buffer The buffer to render into
+/// @param player_handcards The hand cards of the player
+///
+/// @return void
+//
+void renderPlayerHandCards(OutputBuffer *buffer, Card *const *player_handcards)
+{
+  Card *head = *player_handcards;
+  if (head != NULL && head->color_ != '\0')
+  {
+    appendToOutputBuffer(buffer, "  hand cards: ", 14);
+  }
+  else
+  {
+    appendToOutputBuffer(buffer, "  hand cards:\n", 14);
+  }
+  for (; head != NULL && head->color_ != '\0'; head = head->next_)
+  {
+    appendCardLabel(buffer, head, head->next_ != NULL ? ' ' : '\n');
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to render the label of a card, for example "57_g", followed by a separator character. The value
+/// is taken from the precomputed labels, only values outside of their range are formatted.
+///
+/// @param buffer The buffer to render into
+/// @param card The card to render
+/// @param separator The character that follows the label
+///
+/// @return void
+//
+void appendCardLabel(OutputBuffer *buffer, const Card *card, char separator)
+{
+  char label[16];
+  int length;
+  if (card->value_ >= 0 && card->value_ < CARD_SET_SIZE)
+  {
+    length = strlen(CARD_VALUE_LABELS[card->value_]);
+    memcpy(label, CARD_VALUE_LABELS[card->value_], length);
+  }
+  else
+  {
+    length = snprintf(label, sizeof(label), "%i", card->value_);
+  }
+  label[length++] = '_';
+  label[length++] = (char)card->color_;
+  label[length++] = separator;
+  appendToOutputBuffer(buffer, label, length);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function appends bytes to an output buffer and grows it with realloc if necessary. If the buffer cannot grow,
+/// its content and the new bytes are written to stdout directly, so no output is lost.
+///
+/// @param buffer The buffer to append to
+/// @param data The bytes to append
+/// @param length The number of bytes to append
+///
+/// @return void
+//
+void appendToOutputBuffer(OutputBuffer *buffer, const char *data, size_t length)
+{
+  if (buffer->length_ + length > buffer->capacity_)
+  {
+    size_t capacity = buffer->capacity_ == 0 ? OUTPUT_BUFFER_INITIAL_CAPACITY : buffer->capacity_;
+    while (capacity < buffer->length_ + length)
+    {
+      capacity *= 2;
+    }
+    char *temp = realloc(buffer->data_, capacity);
+    if (temp == NULL)
+    {
+      flushOutputBuffer(buffer, stdout);
+      fwrite(data, 1, length, stdout);
+      return;
+    }
+    buffer->data_ = temp;
+    buffer->capacity_ = capacity;
+  }
+  memcpy(buffer->data_ + buffer->length_, data, length);
+  buffer->length_ += length;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function appends a null terminated string to an output buffer.
+///
+/// @param buffer The buffer to append to
+/// @param string The string to append
+///
+/// @return void
+//
+void appendString(OutputBuffer *buffer, const char *string)
+{
+  appendToOutputBuffer(buffer, string, strlen(string));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function appends formatted text to an output buffer, like printf does for the console. The text of a single
+/// call has to fit into OUTPUT_FORMAT_SIZE bytes, it is cut off otherwise.
+///
+/// @param buffer The buffer to append to
+/// @param format The format string, followed by its arguments
+///
+/// @return void
+//
+void appendFormatted(OutputBuffer *buffer, const char *format, ...)
+{
+  char text[OUTPUT_FORMAT_SIZE];
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf(text, sizeof(text), format, arguments);
+  va_end(arguments);
+  if (length < 0)
+  {
+    return;
+  }
+  appendToOutputBuffer(buffer, text, (size_t)length < sizeof(text) ? (size_t)length : sizeof(text) - 1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function writes the content of an output buffer to a stream with a single call and empties the buffer. The
+/// memory of the buffer is kept for the next output.
+///
+/// @param buffer The buffer to flush
+/// @param stream The stream to write to
+///
+/// @return void
+//
+void flushOutputBuffer(OutputBuffer *buffer, FILE *stream)
+{
+  if (buffer->length_ > 0)
+  {
+    fwrite(buffer->data_, 1, buffer->length_, stream);
+    buffer->length_ = 0;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function frees the memory of an output buffer.
+///
+/// @param buffer The buffer to free
+///
+/// @return void
+//
+void freeOutputBuffer(OutputBuffer *buffer)
+{
+  free(buffer->data_);
+  buffer->data_ = NULL;
+  buffer->length_ = 0;
+  buffer->capacity_ = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Retrieves a card from the hand cards of a player by its value. It returns a pointer to the card. The lookup is a
+/// single bit test in the hand card set, only values outside of the range of a CardSet are searched in the list.
+///
+/// @param player The player whose hand cards are searched
+/// @param card_number The value of the card to retrieve
+///
+/// @return
+///      NULL if the card could not be found
+///      a pointer to the card if the card could be found
+//
+Card *getCardFromHand(const Player *player, int card_number)
+{
+  if (card_number >= 0 && card_number < CARD_SET_SIZE)
+  {
+    STATS_ADD(hand_nodes_visited_, 1);
+    return isInCardSet(&player->handset_, card_number) ? player->hand_index_[card_number] : NULL;
+  }
+  Card *head = player->handcards_;
+  while (head != NULL)
+  {
+    STATS_ADD(hand_nodes_visited_, 1);
+    if (head->value_ == card_number)
+    {
+      return head;
+    }
+    head = head->next_;
+  }
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Retrieves a card from the chosen cards of a player by its value. It returns a pointer to the card. A value that is
+/// not in the chosen card set is rejected with a single bit test, otherwise the few chosen cards are searched.
+///
+/// @param player The player whose chosen cards are searched
+/// @param card_number The value of the card to retrieve
+///
+/// @return
+///      NULL if the card could not be found
+///      a pointer to the card if the card could be found
+//
+Card *getCardFromChosen(const Player *player, int card_number)
+{
+  if (card_number >= 0 && card_number < CARD_SET_SIZE && !isInCardSet(&player->chosenset_, card_number))
+  {
+    STATS_ADD(chosen_nodes_visited_, 1);
+    return NULL;
+  }
+  Card *head = player->chosencards_;
+  while (head != NULL)
+  {
+    STATS_ADD(chosen_nodes_visited_, 1);
+    if (head->value_ == card_number)
+    {
+      return head;
+    }
+    head = head->next_;
+  }
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function simulates the choosing phase, where each player chooses two cards to keep from his hand cards. It
+/// returns 0 if the action choosing phase could be performed successfully and 1 otherwise. A player that is played by
+/// the computer chooses without input.
+///
+/// @param player The player that chooses a card
+/// @param opponent The other player, which the hint command takes into account
+///
+/// @return
+///      0 if the action choosing phase could be performed successfully
+///      1 if the action choosing phase could not be performed successfully
+//
+int chooseCardToKeep(Player *player, const Player *opponent)
+{
+  if (player->bot_)
+  {
+    return botChooseCardToKeep(player, opponent);
+  }
+  Card *chosen_card;
+  do
+  {
+    chosen_card = NULL;
+    int card_number;
+    printf("P%i > ", player->id_);
+    char *input;
+    int input_error = readInput(&input);
+    if (input_error != 0)
+    {
+      // The end of the input ends the game like quit does
+      if (input_error == MEMORY_ALLOCATION_ERROR)
+      {
+        printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+      }
+      return 1;
+    }
+    Command command;
+    parseChoosingCommand(input, &command);
+    if (command.type_ == COMMAND_QUIT)
+    {
+      if (command.arguments_count_ > 0)
+      {
+        printInvalidCommand(WRONG_PARAMETERS_COUNT);
+        continue;
+      }
+      logEvent(EVENT_QUIT, 0, 0);
+      return 1;
+    }
+    else if (command.type_ == COMMAND_HINT)
+    {
+      if (command.arguments_count_ > 0)
+      {
+        printInvalidCommand(WRONG_PARAMETERS_COUNT);
+      }
+      else if (hintAction(player, opponent, PHASE_CHOOSING) != 0)
+      {
+        printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+        return 1;
+      }
+      continue;
+    }
+    card_number = command.arguments_[0];
+    if (card_number < 1)
+    {
+      printInvalidCommand(WRONG_HANDCARDS_NUMBER);
+      continue;
+    }
+    chosen_card = getCardFromHand(player, card_number);
+    if (chosen_card == NULL)
+    {
+      printInvalidCommand(WRONG_HANDCARDS_NUMBER);
+    }
+    else
+    {
+      break;
+    }
+  } while (TRUE);
+  if (chosen_card != NULL)
+  {
+    removeCardFromHand(player, chosen_card);
+    addCardToChosen(player, chosen_card);
+    logEvent(EVENT_CHOOSE, 0, chosen_card->value_);
+  }
+  else
+  {
+    printf("Error: Chosen card is NULL\n");
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function adds a card to the chosen cards of a player. It adds the card to the correct position in the list
+/// based on its value, keeping the list in ascending order.
+///
+/// @param player The player whose chosen cards are extended
+/// @param card The card to add
+///
+/// @return void
+//
+void addCardToChosen(Player *player, Card *card)
+{
+  Card **player_chosencard = &player->chosencards_;
+  addToCardSet(&player->chosenset_, card->value_);
+  if (*player_chosencard == NULL || (*player_chosencard)->color_ == '\0')
+  {
+    *player_chosencard = card;
+    (*player_chosencard)->next_ = NULL;
+    return;
+  }
+  Card *head = *player_chosencard;
+  Card *prev = NULL;
+  while (head != NULL && card->value_ > head->value_)
+  {
+    prev = head;
+    head = head->next_;
+  }
+  if (prev == NULL)
+  {
+    // Insert at the beginning of the list
+    card->next_ = *player_chosencard;
+    *player_chosencard = card;
+  }
+  else
+  {
+    // Insert in the middle or at the end of the list
+    prev->next_ = card;
+    card->next_ = head;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function removes a card from the chosen cards of a player. It loops through the list and removes the card if
+/// it is found. It returns 0 if the card could be removed and 1 otherwise.
+///
+/// @param player The player whose chosen cards are searched
+/// @param card The card to remove
+///
+/// @return
+///      0 if the card could be removed
+///      1 if the card could not be removed
+//
+int removeCardFromChosen(Player *player, Card *card)
+{
+  Card **player_chosencards = &player->chosencards_;
+  if (*player_chosencards == NULL)
+  {
+    return 1;
+  }
+  if (*player_chosencards == card)
+  {
+    *player_chosencards = card->next_;
+    card->next_ = NULL;
+    removeFromCardSet(&player->chosenset_, card->value_);
+    return 0;
+  }
+  Card *head = *player_chosencards;
+  while (head->next_ != NULL && head->next_ != card)
+  {
+    head = head->next_;
+  }
+  if (head->next_ != NULL)
+  {
+    head->next_ = card->next_;
+    card->next_ = NULL;
+    removeFromCardSet(&player->chosenset_, card->value_);
+    return 0;
+  }
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function removes a card from the hand cards of a player. It loops through the list and removes the card if it
+/// is found. It returns 0 if the card could be removed and 1 otherwise.
+///
+/// @param player The player whose hand cards are searched
+/// @param card The card to remove
+///
+/// @return
+///      0 if the card could be removed
+///      1 if the card could not be removed
+//
+int removeCardFromHand(Player *player, Card *card)
+{
+  Card **player_handcards = &player->handcards_;
+  if (*player_handcards == NULL)
+  {
+    return 1;
+  }
+  else if (*player_handcards == card)
+  {
+    *player_handcards = card->next_;
+    card->next_ = NULL;
+    removeFromCardSet(&player->handset_, card->value_);
+    return 0;
+  }
+  Card *head = *player_handcards;
+  while (head->next_ != NULL && head->next_ != card)
+  {
+    head = head->next_;
+  }
+  if (head->next_ != NULL)
+  {
+    head->next_ = card->next_;
+    card->next_ = NULL;
+    removeFromCardSet(&player->handset_, card->value_);
+    return 0;
+  }
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function adds a card to a row of cards of a player. It adds the card to the correct position in the list based
+/// on its value, keeping the list in ascending order. It uses the row number to determine the correct row.
+/// The card can only be added if the card can be added at the beginning or end of the row. The length, points and
+/// smallest and largest value of the row are updated with the card, so they never have to be recounted. As the row
+/// keeps its last card, both ends are extended in constant time.
+///
+/// @param player The player whose card rows are extended
+/// @param card The card to add
+/// @param row_number The row number to add the card to
+///
+/// @return
+///      0 if the card could be added
+///      1 if the card could not be added
+//
+int addCardToRow(Player *player, Card *card, int row_number)
+{
+  CardRow *row = &player->cardrows_[row_number];
+  card->next_ = NULL;
+  // Only the head or the tail of a row is visited
+  STATS_ADD(row_nodes_visited_, row->head_ != NULL);
+  if (row->head_ == NULL)
+  {
+    row->head_ = card;
+    row->tail_ = card;
+    row->min_value_ = card->value_;
+    row->max_value_ = card->value_;
+  }
+  else if (card->value_ < row->min_value_)
+  {
+    card->next_ = row->head_;
+    row->head_ = card;
+    row->min_value_ = card->value_;
+  }
+  else if (card->value_ > row->max_value_)
+  {
+    row->tail_->next_ = card;
+    row->tail_ = card;
+    row->max_value_ = card->value_;
+  }
+  else
+  {
+    return 1;
+  }
+  row->length_++;
+  row->points_ += getCardPoints(card);
+  addToCardSet(&row->set_, card->value_);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function sorts a list of cards in ascending order of their values. The cards are relinked and keep their
+/// values, so every pointer to a card stays valid and cards with the same value keep their order. Values in the range
+/// of a CardSet are sorted in linear time with one bucket per value, other values with a merge sort.
+///
+/// @param player_cards The head of the list, it is set to the lowest card
+///
+/// @return
+///      0 if the cards could be sorted
+///      1 if there are less than two cards to sort
+//
+int sortCards(Card **player_cards)
+{
+  if (*player_cards == NULL || (*player_cards)->next_ == NULL)
+  {
+    return 1;
+  }
+  int cards_count = 0;
+  int bounded = TRUE;
+  for (const Card *card = *player_cards; card != NULL; card = card->next_)
+  {
+    cards_count++;
+    bounded = bounded && card->value_ >= 0 && card->value_ < CARD_SET_SIZE;
+  }
+  if (bounded)
+  {
+    bucketSortCards(player_cards);
+  }
+  else
+  {
+    *player_cards = mergeSortCards(*player_cards, cards_count);
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function sorts a list of cards with values in the range of a CardSet. Every card is appended to the bucket of
+/// its value, then the buckets are linked in order. Only the buckets of values that occur are visited, they are found
+/// in a CardSet, so a short hand is sorted without touching all buckets.
+///
+/// @param head The head of the list, it is set to the lowest card
+///
+/// @return void
+//
+void bucketSortCards(Card **head)
+{
+  Card *bucket_heads[CARD_SET_SIZE];
+  Card *bucket_tails[CARD_SET_SIZE];
+  CardSet values = {{0}};
+  Card *next = NULL;
+  for (Card *card = *head; card != NULL; card = next)
+  {
+    next = card->next_;
+    card->next_ = NULL;
+    if (isInCardSet(&values, card->value_))
+    {
+      bucket_tails[card->value_]->next_ = card;
+    }
+    else
+    {
+      addToCardSet(&values, card->value_);
+      bucket_heads[card->value_] = card;
+    }
+    bucket_tails[card->value_] = card;
+  }
+  Card **link = head;
+  for (int word = 0; word < CARD_SET_WORDS; word++)
+  {
+    // Clearing the lowest set bit visits the values of a word in ascending order
+    for (uint64_t bits = values.words_[word]; bits != 0; bits &= bits - 1)
+    {
+      int value = word * 64 + __builtin_ctzll(bits);
+      *link = bucket_heads[value];
+      link = &bucket_tails[value]->next_;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function sorts a list of cards with a merge sort, which works for any values. The list is split by the number
+/// of cards, so it is not walked to find its middle, and equal cards keep their order.
+///
+/// @param head The head of the list
+/// @param cards_count The number of cards in the list
+///
+/// @return
+///      the head of the sorted list
+//
+Card *mergeSortCards(Card *head, int cards_count)
+{
+  if (cards_count < 2)
+  {
+    return head;
+  }
+  Card *last_first = head;
+  for (int i = 1; i < cards_count / 2; i++)
+  {
+    last_first = last_first->next_;
+  }
+  Card *second = last_first->next_;
+  last_first->next_ = NULL;
+  Card *first = mergeSortCards(head, cards_count / 2);
+  second = mergeSortCards(second, cards_count - cards_count / 2);
+  Card *merged = NULL;
+  Card **link = &merged;
+  while (first != NULL && second != NULL)
+  {
+    Card **smaller = second->value_ < first->value_ ? &second : &first;
+    *link = *smaller;
+    link = &(*smaller)->next_;
+    *smaller = (*smaller)->next_;
+  }
+  *link = first != NULL ? first : second;
+  return merged;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function simulates the action phase. It starts with the first player and lets them choose a card from their
+/// chosen cards and add it to one of their card rows. Then it does the same for every following player. It returns 0
+/// if the action phase could be performed successfully and 1 otherwise. Like the card choosing phase it can be
+/// continued at any player.
+///
+/// @param players The players of the game
+/// @param players_count The number of players
+/// @param current_player The index of the player that acts next, it is left at the player that stopped the phase
+///
+/// @return
+///      0 if the action phase could be performed successfully
+///      1 if the action phase could not be performed successfully
+//
+int actionChoosingPhase(Player *players, int players_count, int *current_player)
+{
+  for (; *current_player < players_count; (*current_player)++)
+  {
+    printPlayer(&players[*current_player]);
+    if (actionChoosingLoop(&players[*current_player], &players[(*current_player + 1) % players_count]) == 1)
+    {
+      return 1;
+    }
+    printf("\n");
+  }
+  *current_player = 0;
+  printf(ACTION_PHASE_IS_OVER);
+  printf("\n");
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks if a game is over. The game ends as soon as one player has neither hand cards nor chosen
+/// cards left.
+///
+/// @param players The players of the game
+/// @param players_count The number of players
+///
+/// @return
+///      TRUE if the game is over
+///      FALSE if every player has cards left
+//
+int isGameOver(const Player *players, int players_count)
+{
+  for (int i = 0; i < players_count; i++)
+  {
+    if (players[i].handcards_ == NULL && players[i].chosencards_ == NULL)
+    {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function parses a command of the action phase. Leading and trailing whitespace is ignored and the command
+/// names are matched case insensitively at the start of the input. The words after the command name are its
+/// arguments. The input is read in a single pass and is neither copied nor changed.
+///
+/// @param input The input of the player
+/// @param command The command to fill in
+///
+/// @return void
+//
+void parseActionCommand(const char *input, Command *command)
+{
+  const char *cursor;
+  const char *end;
+  trimCommand(input, &cursor, &end);
+  command->type_ = COMMAND_INVALID;
+  command->arguments_count_ = 0;
+  if (matchCommandKeyword(&cursor, end, QUIT_ACTION))
+  {
+    command->type_ = COMMAND_QUIT;
+  }
+  else if (matchCommandKeyword(&cursor, end, PLACE_ACTION))
+  {
+    command->type_ = COMMAND_PLACE;
+  }
+  else if (matchCommandKeyword(&cursor, end, DISCARD_ACTION))
+  {
+    command->type_ = COMMAND_DISCARD;
+  }
+  else if (matchCommandKeyword(&cursor, end, HELP_ACTION))
+  {
+    command->type_ = COMMAND_HELP;
+  }
+  else if (matchCommandKeyword(&cursor, end, HINT_ACTION))
+  {
+    command->type_ = COMMAND_HINT;
+  }
+  if (command->type_ != COMMAND_INVALID)
+  {
+    parseCommandArguments(cursor, end, command);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function parses a command of the card choosing phase, which is either quit, hint or the number of a card.
+/// Spaces within the number are ignored. The input is read in a single pass and is neither copied nor changed.
+///
+/// @param input The input of the player
+/// @param command The command to fill in, the number of a card is its only argument
+///
+/// @return void
+//
+void parseChoosingCommand(const char *input, Command *command)
+{
+  const char *cursor;
+  const char *end;
+  trimCommand(input, &cursor, &end);
+  if (matchCommandKeyword(&cursor, end, QUIT_ACTION))
+  {
+    command->type_ = COMMAND_QUIT;
+    parseCommandArguments(cursor, end, command);
+    return;
+  }
+  if (matchCommandKeyword(&cursor, end, HINT_ACTION))
+  {
+    command->type_ = COMMAND_HINT;
+    parseCommandArguments(cursor, end, command);
+    return;
+  }
+  command->type_ = COMMAND_NUMBER;
+  command->arguments_count_ = 1;
+  command->arguments_[0] = parseInteger(cursor, end);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to find the part of the input without leading and trailing whitespace.
+///
+/// @param input The input of the player
+/// @param start Is set to the first character that is not whitespace
+/// @param end Is set to the character after the last character that is not whitespace
+///
+/// @return void
+//
+void trimCommand(const char *input, const char **start, const char **end)
+{
+  while (isspace((unsigned char)*input))
+  {
+    input++;
+  }
+  const char *last = input + strlen(input);
+  while (last > input && isspace((unsigned char)last[-1]))
+  {
+    last--;
+  }
+  *start = input;
+  *end = last;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to check case insensitively if the input starts with a command name. If it does, the cursor is
+/// moved behind the name.
+///
+/// @param cursor The current position in the input
+/// @param end The end of the input
+/// @param keyword The command name in lowercase
+///
+/// @return
+///      TRUE if the input starts with the command name
+///      FALSE otherwise
+//
+int matchCommandKeyword(const char **cursor, const char *end, const char *keyword)
+{
+  const char *position = *cursor;
+  for (; *keyword != '\0'; keyword++, position++)
+  {
+    if (position == end || tolower((unsigned char)*position) != *keyword)
+    {
+      return FALSE;
+    }
+  }
+  *cursor = position;
+  return TRUE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to split the rest of a command at spaces into its arguments. The first arguments are converted
+/// to integers, after one more argument than fit into the command the rest of the input is not looked at.
+///
+/// @param cursor The position behind the command name
+/// @param end The end of the input
+/// @param command The command to fill in
+///
+/// @return void
+//
+void parseCommandArguments(const char *cursor, const char *end, Command *command)
+{
+  command->arguments_count_ = 0;
+  while (command->arguments_count_ <= MAX_COMMAND_ARGUMENTS)
+  {
+    while (cursor < end && *cursor == ' ')
+    {
+      cursor++;
+    }
+    if (cursor == end)
+    {
+      return;
+    }
+    const char *word = cursor;
+    while (cursor < end && *cursor != ' ')
+    {
+      cursor++;
+    }
+    if (command->arguments_count_ < MAX_COMMAND_ARGUMENTS)
+    {
+      command->arguments_[command->arguments_count_] = parseInteger(word, cursor);
+    }
+    command->arguments_count_++;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function performs the action choosing phase. It starts with the first player and lets him choose a card from
+/// his chosen cards and add it to one of his card rows. Then it does the same for the second player. It returns 0 if
+/// the action choosing phase could be performed successfully and 1 otherwise. A player that is played by the computer
+/// performs its actions without input.
+///
+/// @param player The player that performs the actions
+/// @param opponent The other player, which the hint command takes into account
+///
+/// @return
+///      0 if the action choosing phase could be performed successfully
+///      1 if the action choosing phase could not be performed successfully
+//
+int actionChoosingLoop(Player *player, const Player *opponent)
+{
+  if (player->bot_)
+  {
+    return botActionChoosingLoop(player, opponent);
+  }
+  int skip_prompt = FALSE;
+  do
+  {
+    if (!skip_prompt)
+    {
+      printf(PROMPT_PLAYER_ACTION);
+    }
+    printf("P%i > ", player->id_);
+    char *input;
+    int input_error = readInput(&input);
+    if (input_error != 0)
+    {
+      // The end of the input ends the game like quit does
+      if (input_error == MEMORY_ALLOCATION_ERROR)
+      {
+        printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+      }
+      return 1;
+    }
+    Command command;
+    parseActionCommand(input, &command);
+    if (command.type_ == COMMAND_QUIT)
+    {
+      if (command.arguments_count_ > 0)
+      {
+        printInvalidCommand(WRONG_PARAMETERS_COUNT);
+        skip_prompt = TRUE;
+        continue;
+      }
+      logEvent(EVENT_QUIT, 0, 0);
+      return 1;
+    }
+    else if (command.type_ == COMMAND_PLACE)
+    {
+      if (placeAction(&command, &skip_prompt, player) == 1)
+      {
+        continue;
+      }
+    }
+    else if (command.type_ == COMMAND_DISCARD)
+    {
+      if (discardAction(&command, &skip_prompt, player) == 1)
+      {
+        continue;
+      }
+    }
+    else if (command.type_ == COMMAND_HELP)
+    {
+      if (command.arguments_count_ > 0)
+      {
+        printInvalidCommand(WRONG_PARAMETERS_COUNT);
+        skip_prompt = TRUE;
+        continue;
+      }
+      helpAction(player);
+    }
+    else if (command.type_ == COMMAND_HINT)
+    {
+      if (command.arguments_count_ > 0)
+      {
+        printInvalidCommand(WRONG_PARAMETERS_COUNT);
+      }
+      else if (hintAction(player, opponent, PHASE_ACTION) != 0)
+      {
+        printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+        return 1;
+      }
+      skip_prompt = TRUE;
+      continue;
+    }
+    else
+    {
+      printInvalidCommand(INVALID_COMMAND);
+      skip_prompt = TRUE;
+      continue;
+    }
+    skip_prompt = FALSE;
+  } while (player->chosencards_ != NULL);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints the help message for the action phase.
+///
+/// @param player The player that asked for help
+///
+/// @return void
+//
+void helpAction(const Player *player)
+{
+  fputs(HELP_MESSAGE, stdout);
+  printf("\n");
+  printPlayer(player);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function performs the hint action. It searches for the best move of the player in the current phase and
+/// prints it in the form of the command that performs it.
+///
+/// @param player The player that asks for a hint
+/// @param opponent The other player
+/// @param phase The phase the game is in
+///
+/// @return
+///      0 if the hint was printed
+///      4 if there was a memory allocation error
+//
+int hintAction(const Player *player, const Player *opponent, GamePhase phase)
+{
+  SearchMove move;
+  if (searchBestMove(player, opponent, phase, &move) != 0)
+  {
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  if (phase == PHASE_CHOOSING)
+  {
+    printf("Hint: keep %i", move.values_[0]);
+    for (int i = 1; i < move.values_count_; i++)
+    {
+      printf(" and %i", move.values_[i]);
+    }
+    printf("\n");
+  }
+  else if (move.row_number_ >= 0)
+  {
+    printf("Hint: place %i %i\n", move.row_number_ + 1, move.values_[0]);
+  }
+  else
+  {
+    printf("Hint: discard %i\n", move.values_[0]);
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function lets the computer choose a card to keep for a player. It prints the card after the prompt, as if it
+/// had been entered. The card is searched for, unless a strategy was selected for the computer.
+///
+/// @param player The player that chooses a card
+/// @param opponent The other player
+///
+/// @return
+///      0 if a card was chosen
+///      1 if there was a memory allocation error
+//
+int botChooseCardToKeep(Player *player, const Player *opponent)
+{
+  SearchMove move;
+  printf("P%i > ", player->id_);
+  Card *chosen_card = NULL;
+  if (bot_strategy != NULL)
+  {
+    // A card that is not in the hand cards is replaced by the first hand card, like in a simulated game
+    chosen_card = askStrategyForCard(bot_strategy, player, opponent, &bot_random_state);
+    if (chosen_card == NULL || getCardFromHand(player, chosen_card->value_) != chosen_card)
+    {
+      chosen_card = player->handcards_;
+    }
+  }
+  else if (searchBestMove(player, opponent, PHASE_CHOOSING, &move) != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return 1;
+  }
+  else
+  {
+    // The search may recommend two cards, the second one is searched for again at the next prompt
+    chosen_card = getCardFromHand(player, move.values_[0]);
+  }
+  printf("%i\n", chosen_card->value_);
+  removeCardFromHand(player, chosen_card);
+  addCardToChosen(player, chosen_card);
+  logEvent(EVENT_CHOOSE, 0, chosen_card->value_);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function lets the computer place or discard all chosen cards of a player. Every action is printed after the
+/// prompt as if it had been entered and then performed like an entered command. The actions are searched for, unless
+/// a strategy was selected for the computer.
+///
+/// @param player The player that performs the actions
+/// @param opponent The other player
+///
+/// @return
+///      0 if all actions were performed
+///      1 if there was a memory allocation error
+//
+int botActionChoosingLoop(Player *player, const Player *opponent)
+{
+  while (player->chosencards_ != NULL)
+  {
+    printf(PROMPT_PLAYER_ACTION);
+    printf("P%i > ", player->id_);
+    SearchMove move;
+    if (bot_strategy != NULL)
+    {
+      // Like in a simulated game, an unknown card is replaced by the first chosen card and a misfit is discarded
+      Card *card = askStrategyForAction(bot_strategy, player, opponent, &move.row_number_, &bot_random_state);
+      if (card == NULL || getCardFromChosen(player, card->value_) != card)
+      {
+        card = player->chosencards_;
+        move.row_number_ = -1;
+      }
+      if (move.row_number_ < 0 || move.row_number_ >= MAX_CARD_ROWS ||
+          !canCardExtendRow(&player->cardrows_[move.row_number_], card))
+      {
+        move.row_number_ = -1;
+      }
+      move.values_[0] = card->value_;
+    }
+    else if (searchBestMove(player, opponent, PHASE_ACTION, &move) != 0)
+    {
+      printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+      return 1;
+    }
+    int skip_prompt = FALSE;
+    Command command;
+    if (move.row_number_ >= 0)
+    {
+      printf("%s %i %i\n", PLACE_ACTION, move.row_number_ + 1, move.values_[0]);
+      command.type_ = COMMAND_PLACE;
+      command.arguments_count_ = 2;
+      command.arguments_[0] = move.row_number_ + 1;
+      command.arguments_[1] = move.values_[0];
+      placeAction(&command, &skip_prompt, player);
+    }
+    else
+    {
+      printf("%s %i\n", DISCARD_ACTION, move.values_[0]);
+      command.type_ = COMMAND_DISCARD;
+      command.arguments_count_ = 1;
+      command.arguments_[0] = move.values_[0];
+      discardAction(&command, &skip_prompt, player);
+    }
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function performs the place action. It returns 0 if the place action could be performed successfully and 1
+/// otherwise, in which case the reason is printed.
+///
+/// @param command The place command with the row number and the card number
+/// @param skip_prompt A pointer to a boolean that indicates if the prompt should be skipped
+/// @param player The player that places the card
+///
+/// @return
+///      0 if the place action could be performed successfully
+///      1 if the place action could not be performed successfully
+//
+int placeAction(const Command *command, int *skip_prompt, Player *player)
+{
+  const char *error_message = applyPlaceCommand(command, player);
+  if (error_message != NULL)
+  {
+    printInvalidCommand(error_message);
+    *skip_prompt = TRUE;
+    return 1;
+  }
+  printf("\n");
+  printPlayer(player);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function performs the discard action. It returns 0 if the discard action could be performed successfully and 1
+/// otherwise, in which case the reason is printed.
+///
+/// @param command The discard command with the card number
+/// @param skip_prompt A pointer to a boolean that indicates if the prompt should be skipped
+/// @param player The player that discards the card
+///
+/// @return
+///      0 if the discard action could be performed successfully
+///      1 if the discard action could not be performed successfully
+//
+int discardAction(const Command *command, int *skip_prompt, Player *player)
+{
+  const char *error_message = applyDiscardCommand(command, player);
+  if (error_message != NULL)
+  {
+    printInvalidCommand(error_message);
+    *skip_prompt = TRUE;
+    return 1;
+  }
+  printf("\n");
+  printPlayer(player);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks a place command and places the card if it is correct. The command needs a valid row number and
+/// the number of a chosen card that can extend the row. The card is only taken from the chosen cards once it is known
+/// to fit, so a rejected placement leaves all lists untouched. Nothing is printed, so the interactive game and the
+/// sessions of the server can report the outcome in their own way.
+///
+/// @param command The place command with the row number and the card number
+/// @param player The player that places the card
+///
+/// @return
+///      NULL if the card was placed
+///      the message that tells why the command was rejected otherwise
+//
+const char *applyPlaceCommand(const Command *command, Player *player)
+{
+  if (command->arguments_count_ != 2)
+  {
+    return WRONG_PARAMETERS_COUNT;
+  }
+  if (command->arguments_[0] > MAX_CARD_ROWS || command->arguments_[0] < 1)
+  {
+    return WRONG_ROW_NUMBER;
+  }
+  Card *choosen_card = getCardFromChosen(player, command->arguments_[1]);
+  if (choosen_card == NULL)
+  {
+    return WRONG_CHOSENCARDS_NUMBER;
+  }
+  int row_number = command->arguments_[0] - 1;
+  if (!canCardExtendRow(&player->cardrows_[row_number], choosen_card))
+  {
+    return CARD_CANNOT_EXTEND_ROW;
+  }
+  removeCardFromChosen(player, choosen_card);
+  addCardToRow(player, choosen_card, row_number);
+  logEvent(EVENT_PLACE, row_number + 1, choosen_card->value_);
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks a discard command and discards the card if it is correct. Like applyPlaceCommand it prints
+/// nothing.
+///
+/// @param command The discard command with the card number
+/// @param player The player that discards the card
+///
+/// @return
+///      NULL if the card was discarded
+///      the message that tells why the command was rejected otherwise
+//
+const char *applyDiscardCommand(const Command *command, Player *player)
+{
+  if (command->arguments_count_ != 1)
+  {
+    return WRONG_PARAMETERS_COUNT;
+  }
+  Card *choosen_card = getCardFromChosen(player, command->arguments_[0]);
+  if (choosen_card == NULL)
+  {
+    return WRONG_CHOSENCARDS_NUMBER;
+  }
+  removeCardFromChosen(player, choosen_card);
+  logEvent(EVENT_DISCARD, 0, choosen_card->value_);
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function performs the game end phase. It calculates the points of the given player and returns the total.
+/// It only reads the running totals of the rows, so it can be called at any time of the game in constant time.
+///
+/// @param player_cardrows The card rows of the player
+///
+/// @return
+///      The total points of the player
+//
+int calculatePlayerPoints(const CardRow *player_cardrows)
+{
+  int points = 0;
+  int longest_row_length = 0;
+  int longest_row_index = -1;
+  // Find the longest row and its index
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    if (player_cardrows[i].length_ > longest_row_length)
+    {
+      longest_row_length = player_cardrows[i].length_;
+      longest_row_index = i;
+    }
+  }
+  // Calculate points from the running row totals, applying multiplier only to the longest row with the lowest index
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    points += player_cardrows[i].points_;
+    if (i == longest_row_index)
+    {
+      points *= 2;
+    }
+  }
+  return points;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns the points a card is worth at the end of the game, which depend only on its color.
+///
+/// @param card The card to count
+///
+/// @return
+///      the points of the card
+//
+int getCardPoints(const Card *card)
+{
+  return CARD_COLOR_POINTS[(unsigned char)card->color_];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function allocates the arrays of a board batch in a single block. The batch starts empty.
+///
+/// @param batch The batch to initialize
+/// @param capacity The number of boards the batch can hold
+///
+/// @return
+///      0 if the batch was initialized
+///      4 if there was a memory allocation error
+//
+int initBoardBatch(BoardBatch *batch, int capacity)
+{
+  int32_t *memory = malloc(sizeof(int32_t) * (2 * MAX_CARD_ROWS + 1) * (capacity > 0 ? capacity : 1));
+  if (memory == NULL)
+  {
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    batch->row_points_[i] = memory + (size_t)i * capacity;
+    batch->row_lengths_[i] = memory + (size_t)(MAX_CARD_ROWS + i) * capacity;
+  }
+  batch->points_ = memory + (size_t)2 * MAX_CARD_ROWS * capacity;
+  batch->count_ = 0;
+  batch->capacity_ = capacity;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function frees the arrays of a board batch.
+///
+/// @param batch The batch to free
+///
+/// @return void
+//
+void freeBoardBatch(BoardBatch *batch)
+{
+  // The first array is the start of the block all arrays live in
+  free(batch->row_points_[0]);
+  batch->count_ = 0;
+  batch->capacity_ = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function adds the board of a player to a batch. Only the running totals of the rows are copied.
+///
+/// @param batch The batch to add to
+/// @param cardrows The card rows of the player
+///
+/// @return
+///      0 if the board was added
+///      1 if the batch is full
+//
+int addBoardToBatch(BoardBatch *batch, const CardRow *cardrows)
+{
+  if (batch->count_ == batch->capacity_)
+  {
+    return 1;
+  }
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    batch->row_points_[i][batch->count_] = cardrows[i].points_;
+    batch->row_lengths_[i][batch->count_] = cardrows[i].length_;
+  }
+  batch->count_++;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function scores all boards of a batch like calculatePlayerPoints scores a single board and stores the points
+/// in the points array of the batch. The longest row is found and the points are doubled without a branch: with rows
+/// of length l0, l1 and l2 the first row is the longest if l0 > 0, l0 >= l1 and l0 >= l2, the second one if l1 > l0
+/// and l1 >= l2 and the third one if l2 > l0 and l2 > l1. As calculatePlayerPoints doubles the sum of all rows up to
+/// the longest one, the points of these rows are added a second time. With AVX2 eight boards and with SSE2 four
+/// boards are scored at once, the remaining boards and other processors use the scalar code.
+///
+/// @param batch The batch to score
+///
+/// @return void
+//
+void scoreBoardBatch(BoardBatch *batch)
+{
+  _Static_assert(MAX_CARD_ROWS == 3, "the vector code scores exactly three rows");
+  int i = 0;
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  for (; i + 8 <= batch->count_; i += 8)
+  {
+    __m256i points_0 = _mm256_loadu_si256((const __m256i *)(batch->row_points_[0] + i));
+    __m256i points_1 = _mm256_loadu_si256((const __m256i *)(batch->row_points_[1] + i));
+    __m256i points_2 = _mm256_loadu_si256((const __m256i *)(batch->row_points_[2] + i));
+    __m256i length_0 = _mm256_loadu_si256((const __m256i *)(batch->row_lengths_[0] + i));
+    __m256i length_1 = _mm256_loadu_si256((const __m256i *)(batch->row_lengths_[1] + i));
+    __m256i length_2 = _mm256_loadu_si256((const __m256i *)(batch->row_lengths_[2] + i));
+    __m256i second_beats_first = _mm256_cmpgt_epi32(length_1, length_0);
+    __m256i third_beats_first = _mm256_cmpgt_epi32(length_2, length_0);
+    __m256i third_beats_second = _mm256_cmpgt_epi32(length_2, length_1);
+    __m256i first_longest = _mm256_andnot_si256(_mm256_or_si256(second_beats_first, third_beats_first),
+                                                _mm256_cmpgt_epi32(length_0, zero));
+    __m256i second_longest = _mm256_andnot_si256(third_beats_second, second_beats_first);
+    __m256i third_longest = _mm256_and_si256(third_beats_first, third_beats_second);
+    __m256i first_two_rows = _mm256_add_epi32(points_0, points_1);
+    __m256i all_rows = _mm256_add_epi32(first_two_rows, points_2);
+    __m256i doubled = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(first_longest, points_0),
+                                                      _mm256_and_si256(second_longest, first_two_rows)),
+                                      _mm256_and_si256(third_longest, all_rows));
+    _mm256_storeu_si256((__m256i *)(batch->points_ + i), _mm256_add_epi32(all_rows, doubled));
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= batch->count_; i += 4)
+  {
+    __m128i points_0 = _mm_loadu_si128((const __m128i *)(batch->row_points_[0] + i));
+    __m128i points_1 = _mm_loadu_si128((const __m128i *)(batch->row_points_[1] + i));
+    __m128i points_2 = _mm_loadu_si128((const __m128i *)(batch->row_points_[2] + i));
+    __m128i length_0 = _mm_loadu_si128((const __m128i *)(batch->row_lengths_[0] + i));
+    __m128i length_1 = _mm_loadu_si128((const __m128i *)(batch->row_lengths_[1] + i));
+    __m128i length_2 = _mm_loadu_si128((const __m128i *)(batch->row_lengths_[2] + i));
+    __m128i second_beats_first = _mm_cmpgt_epi32(length_1, length_0);
+    __m128i third_beats_first = _mm_cmpgt_epi32(length_2, length_0);
+    __m128i third_beats_second = _mm_cmpgt_epi32(length_2, length_1);
+    __m128i first_longest = _mm_andnot_si128(_mm_or_si128(second_beats_first, third_beats_first),
+                                             _mm_cmpgt_epi32(length_0, zero));
+    __m128i second_longest = _mm_andnot_si128(third_beats_second, second_beats_first);
+    __m128i third_longest = _mm_and_si128(third_beats_first, third_beats_second);
+    __m128i first_two_rows = _mm_add_epi32(points_0, points_1);
+    __m128i all_rows = _mm_add_epi32(first_two_rows, points_2);
+    __m128i doubled = _mm_or_si128(_mm_or_si128(_mm_and_si128(first_longest, points_0),
+                                                _mm_and_si128(second_longest, first_two_rows)),
+                                   _mm_and_si128(third_longest, all_rows));
+    _mm_storeu_si128((__m128i *)(batch->points_ + i), _mm_add_epi32(all_rows, doubled));
+  }
+#endif
+  for (; i < batch->count_; i++)
+  {
+    batch->points_[i] = scoreBatchBoard(batch, i);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function scores a single board of a batch without vector instructions, in the same way as
+/// calculatePlayerPoints.
+///
+/// @param batch The batch
+/// @param index The index of the board
+///
+/// @return
+///      the points of the board
+//
+int scoreBatchBoard(const BoardBatch *batch, int index)
+{
+  int points = 0;
+  int longest_row_length = 0;
+  int longest_row_index = -1;
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    if (batch->row_lengths_[i][index] > longest_row_length)
+    {
+      longest_row_length = batch->row_lengths_[i][index];
+      longest_row_index = i;
+    }
+  }
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    points += batch->row_points_[i][index];
+    if (i == longest_row_index)
+    {
+      points *= 2;
+    }
+  }
+  return points;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function initializes a player without any cards.
+///
+/// @param player The player to initialize
+/// @param player_id The number of the player
+///
+/// @return void
+//
+void initPlayer(Player *player, int player_id)
+{
+  player->id_ = player_id;
+  player->handcards_ = NULL;
+  player->chosencards_ = NULL;
+  memset(&player->handset_, 0, sizeof(player->handset_));
+  memset(&player->chosenset_, 0, sizeof(player->chosenset_));
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    memset(&player->cardrows_[i], 0, sizeof(player->cardrows_[i]));
+  }
+  player->bot_ = FALSE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function adds a card to the hand card set and to the hand card index of a player, so that it can be found by
+/// its value in constant time. Cards with values outside of the range of a CardSet are not indexed, they are searched
+/// in the list instead.
+///
+/// @param player The player whose hand holds the card
+/// @param card The card to index
+///
+/// @return void
+//
+void indexHandCard(Player *player, Card *card)
+{
+  addToCardSet(&player->handset_, card->value_);
+  if (card->value_ >= 0 && card->value_ < CARD_SET_SIZE)
+  {
+    player->hand_index_[card->value_] = card;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function rebuilds the hand card set and the hand card index of a player from the list of his hand cards. It is
+/// called whenever a whole hand is handed to a player, the cost is the number of cards in the hand.
+///
+/// @param player The player whose hand cards are indexed
+///
+/// @return void
+//
+void indexHandCards(Player *player)
+{
+  memset(&player->handset_, 0, sizeof(player->handset_));
+  for (Card *card = player->handcards_; card != NULL; card = card->next_)
+  {
+    indexHandCard(player, card);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks if a card can be added to a row, which is the case if the row is empty or if the card can be
+/// added at the beginning or the end of the row.
+///
+/// @param row The row to check
+/// @param card The card to check
+///
+/// @return
+///      TRUE if the card can extend the row
+///      FALSE otherwise
+//
+int canCardExtendRow(const CardRow *row, const Card *card)
+{
+  return row->head_ == NULL || card->value_ < row->min_value_ || card->value_ > row->max_value_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function copies a linked list of cards into an arena. The copy keeps the order of the original list.
+///
+/// @param arena The arena the copied cards are taken from
+/// @param head The head of the list to copy
+/// @param copy Output parameter for the head of the copied list
+///
+/// @return
+///      0 if the list could be copied
+///      4 if the arena is full
+//
+int copyCardList(CardArena *arena, const Card *head, Card **copy)
+{
+  *copy = NULL;
+  Card **next = copy;
+  while (head != NULL)
+  {
+    Card *card = allocateCard(arena);
+    if (card == NULL)
+    {
+      *copy = NULL;
+      return MEMORY_ALLOCATION_ERROR;
+    }
+    card->color_ = head->color_;
+    card->value_ = head->value_;
+    card->next_ = NULL;
+    *next = card;
+    next = &card->next_;
+    head = head->next_;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function runs the batch simulation mode. The config file is loaded once, then the requested number of games
+/// is played by one worker thread per core without any output. Each game uses its own random seed derived from the
+/// game number, so the results do not depend on the number of threads. At the end a summary is printed.
+///
+/// @param options The parsed command line options
+///
+/// @return
+///      0 if the simulation was executed successfully
+///      2 if the config file could not be opened
+///      3 if the config file is invalid
+///      4 if there was a memory allocation error
+//
+int runSimulation(const Options *options)
+{
+  int players_count = 0;
+  SimulationJob job;
+  if (initCardArena(&job.deck_arena_, DECK_SIZE) != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  int config_file_error = loadConfigFile(options->config_file_, &job.deck_arena_, &players_count, job.deck_players_,
+                                         MIN_PLAYERS);
+  if (config_file_error != 0)
+  {
+    freeCardArena(&job.deck_arena_);
+    return config_file_error;
+  }
+  job.strategies_[0] = options->strategies_[0];
+  job.strategies_[1] = options->strategies_[1];
+  job.deck_hash_ = hashDeck(job.deck_players_, 2);
+  job.games_count_ = options->simulate_games_;
+  atomic_init(&job.next_game_, 0);
+
+  long threads_count = sysconf(_SC_NPROCESSORS_ONLN);
+  long chunks_count = (job.games_count_ + SIMULATION_CHUNK_SIZE - 1) / SIMULATION_CHUNK_SIZE;
+  if (threads_count < 1)
+  {
+    threads_count = 1;
+  }
+  if (threads_count > chunks_count)
+  {
+    threads_count = chunks_count;
+  }
+  if (threads_count > MAX_SIMULATION_THREADS)
+  {
+    threads_count = MAX_SIMULATION_THREADS;
+  }
+  SimulationWorker *workers = calloc(threads_count, sizeof(SimulationWorker));
+  if (workers == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    freeCardArena(&job.deck_arena_);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  struct timespec start_time;
+  struct timespec end_time;
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  long started_count = 0;
+  for (long i = 0; i < threads_count; i++)
+  {
+    workers[i].job_ = &job;
+    if (pthread_create(&workers[i].thread_, NULL, simulationWorker, &workers[i]) != 0)
+    {
+      break;
+    }
+    started_count++;
+  }
+  for (long i = 0; i < started_count; i++)
+  {
+    pthread_join(workers[i].thread_, NULL);
+  }
+  if (started_count == 0)
+  {
+    // Fall back to simulating on the main thread
+    simulationWorker(&workers[0]);
+    started_count = 1;
+  }
+  SimulationResult total = {0, {0, 0}, 0, {0, 0}};
+  int error = 0;
+  for (long i = 0; i < started_count; i++)
+  {
+    error |= workers[i].error_;
+    total.games_ += workers[i].result_.games_;
+    total.ties_ += workers[i].result_.ties_;
+    for (int player = 0; player < 2; player++)
+    {
+      total.wins_[player] += workers[i].result_.wins_[player];
+      total.points_[player] += workers[i].result_.points_[player];
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+  double seconds = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+  free(workers);
+  freeCardArena(&job.deck_arena_);
+  if (closeJournal(&results_journal) != 0)
+  {
+    printf(WARNING_JOURNAL_NOT_WRITTEN);
+  }
+  if (error != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  printf("Simulated %ld games on %ld threads in %.3f s (%.0f games/s)\n", total.games_, started_count, seconds,
+         seconds > 0 ? total.games_ / seconds : 0.0);
+  for (int player = 0; player < 2; player++)
+  {
+    printf("Player %i (%s): %ld wins, %.2f points on average\n", player + 1, job.strategies_[player]->name_,
+           total.wins_[player], (double)total.points_[player] / total.games_);
+  }
+  printf("Ties: %ld\n", total.ties_);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This is the entry point of a simulation thread. It takes chunks of game numbers from the shared job until all games
+/// are played and collects the results of its own games. The thread reuses one card arena for all of its games and
+/// collects the records for the results journal in its own batch.
+///
+/// @param argument The SimulationWorker of this thread
+///
+/// @return NULL
+//
+void *simulationWorker(void *argument)
+{
+  SimulationWorker *worker = argument;
+  SimulationJob *job = worker->job_;
+  int points[2];
+  if (initCardArena(&worker->arena_, DECK_SIZE) != 0)
+  {
+    worker->error_ = MEMORY_ALLOCATION_ERROR;
+    return NULL;
+  }
+  while (worker->error_ == 0)
+  {
+    long first_game = atomic_fetch_add(&job->next_game_, SIMULATION_CHUNK_SIZE);
+    if (first_game >= job->games_count_)
+    {
+      break;
+    }
+    long last_game = first_game + SIMULATION_CHUNK_SIZE;
+    if (last_game > job->games_count_)
+    {
+      last_game = job->games_count_;
+    }
+    for (long game = first_game; game < last_game; game++)
+    {
+      uint64_t random_state = (uint64_t)game;
+      long long start_ns = results_journal.fd_ >= 0 ? getMonotonicTimeNs() : 0;
+      if (simulateGame(&worker->arena_, job->deck_players_, job->strategies_, &random_state, points) != 0)
+      {
+        worker->error_ = MEMORY_ALLOCATION_ERROR;
+        break;
+      }
+      if (results_journal.fd_ >= 0)
+      {
+        JournalRecord record;
+        fillJournalRecord(&record, job->deck_hash_, points, 2, start_ns);
+        addJournalRecord(&results_journal, &worker->journal_batch_, &record);
+      }
+      worker->result_.games_++;
+      worker->result_.points_[0] += points[0];
+      worker->result_.points_[1] += points[1];
+      if (points[0] > points[1])
+      {
+        worker->result_.wins_[0]++;
+      }
+      else if (points[0] < points[1])
+      {
+        worker->result_.wins_[1]++;
+      }
+      else
+      {
+        worker->result_.ties_++;
+      }
+    }
+  }
+  flushJournalBatch(&results_journal, &worker->journal_batch_, TRUE);
+  freeCardArena(&worker->arena_);
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function runs a round-robin tournament. Every deck of the deck list is played by every ordered pair of the
+/// strategies given with --strategy (all strategies if none are given), so each pair plays each deck from both seats.
+/// The games are spread over a work-stealing pool with one worker thread per core: every worker starts with an equal
+/// range of games, and a worker that has run out of games steals half of the games another worker has left, so all
+/// cores stay busy until the last game. Each game uses the game number as its random seed, so the results do not
+/// depend on the number of threads. At the end the standings of the strategies are printed.
+///
+/// @param options The parsed command line options
+///
+/// @return
+///      0 if the tournament was executed successfully
+///      2 if a config file of the deck list could not be opened
+///      3 if the deck list or one of its config files is invalid
+///      4 if there was a memory allocation error
+//
+int runTournament(const Options *options)
+{
+  TournamentJob job;
+  job.strategies_count_ = options->strategies_count_;
+  for (int i = 0; i < job.strategies_count_; i++)
+  {
+    job.strategies_[i] = options->strategies_[i];
+  }
+  // Without strategy options every strategy takes part, the loaded plugins as well
+  if (job.strategies_count_ == 0)
+  {
+    for (int i = 0; i < STRATEGIES_COUNT; i++)
+    {
+      job.strategies_[job.strategies_count_++] = &STRATEGIES[i];
+    }
+    for (int i = 0; i < plugin_strategies_count; i++)
+    {
+      job.strategies_[job.strategies_count_++] = &plugin_strategies[i];
+    }
+  }
+  if (job.strategies_count_ < 2)
+  {
+    printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+    return WRONG_ARGUMENT_COUNT;
+  }
+  int deck_error = loadTournamentDecks(options->tournament_file_, &job);
+  if (deck_error != 0)
+  {
+    return deck_error;
+  }
+  job.games_per_pairing_ = options->tournament_games_;
+  job.pairings_count_ = (long)job.strategies_count_ * (job.strategies_count_ - 1);
+  if (job.games_per_pairing_ > MAX_TOURNAMENT_GAMES / job.pairings_count_ / job.decks_count_)
+  {
+    printf(WRONG_ARGUMENT_COUNT_MESSAGE);
+    freeTournamentDecks(&job);
+    return WRONG_ARGUMENT_COUNT;
+  }
+  job.games_count_ = job.decks_count_ * job.pairings_count_ * job.games_per_pairing_;
+
+  long threads_count = sysconf(_SC_NPROCESSORS_ONLN);
+  long chunks_count = (job.games_count_ + TOURNAMENT_CHUNK_SIZE - 1) / TOURNAMENT_CHUNK_SIZE;
+  if (threads_count < 1)
+  {
+    threads_count = 1;
+  }
+  if (threads_count > chunks_count)
+  {
+    threads_count = chunks_count;
+  }
+  if (threads_count > MAX_SIMULATION_THREADS)
+  {
+    threads_count = MAX_SIMULATION_THREADS;
+  }
+  TournamentWorker *workers = calloc(threads_count, sizeof(TournamentWorker));
+  if (workers == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    freeTournamentDecks(&job);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  job.workers_ = workers;
+  job.workers_count_ = threads_count;
+  // All ranges are set up before the first worker starts, because every worker may steal from every other one
+  for (long i = 0; i < threads_count; i++)
+  {
+    workers[i].job_ = &job;
+    workers[i].index_ = i;
+    pthread_mutex_init(&workers[i].range_.mutex_, NULL);
+    workers[i].range_.begin_ = job.games_count_ * i / threads_count;
+    workers[i].range_.end_ = job.games_count_ * (i + 1) / threads_count;
+  }
+  long long start_ns = getMonotonicTimeNs();
+  long started_count = 0;
+  for (long i = 0; i < threads_count; i++)
+  {
+    if (pthread_create(&workers[i].thread_, NULL, tournamentWorker, &workers[i]) != 0)
+    {
+      break;
+    }
+    started_count++;
+  }
+  // The games of workers that could not be started are stolen by the others
+  if (started_count == 0)
+  {
+    tournamentWorker(&workers[0]);
+  }
+  for (long i = 0; i < started_count; i++)
+  {
+    pthread_join(workers[i].thread_, NULL);
+  }
+  double seconds = (getMonotonicTimeNs() - start_ns) / 1e9;
+  TournamentStanding standings[MAX_STRATEGY_OPTIONS];
+  memset(standings, 0, sizeof(standings));
+  long games_count = 0;
+  long stolen_count = 0;
+  int error = 0;
+  for (int i = 0; i < job.strategies_count_; i++)
+  {
+    standings[i].strategy_index_ = i;
+  }
+  for (long i = 0; i < threads_count; i++)
+  {
+    error |= workers[i].error_;
+    stolen_count += workers[i].stolen_games_;
+    for (int j = 0; j < job.strategies_count_; j++)
+    {
+      standings[j].games_ += workers[i].standings_[j].games_;
+      standings[j].wins_ += workers[i].standings_[j].wins_;
+      standings[j].ties_ += workers[i].standings_[j].ties_;
+      standings[j].losses_ += workers[i].standings_[j].losses_;
+      standings[j].points_ += workers[i].standings_[j].points_;
+    }
+    pthread_mutex_destroy(&workers[i].range_.mutex_);
+  }
+  for (int i = 0; i < job.strategies_count_; i++)
+  {
+    games_count += standings[i].games_;
+  }
+  games_count /= 2;
+  int decks_count = job.decks_count_;
+  free(workers);
+  freeTournamentDecks(&job);
+  if (closeJournal(&results_journal) != 0)
+  {
+    printf(WARNING_JOURNAL_NOT_WRITTEN);
+  }
+  if (error != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  printf("Played %ld games on %d decks on %ld threads in %.3f s (%.0f games/s, %ld games stolen)\n", games_count,
+         decks_count, started_count > 0 ? started_count : 1, seconds, seconds > 0 ? games_count / seconds : 0.0,
+         stolen_count);
+  qsort(standings, job.strategies_count_, sizeof(TournamentStanding), compareTournamentStandings);
+  for (int i = 0; i < job.strategies_count_; i++)
+  {
+    const TournamentStanding *standing = &standings[i];
+    printf("%i. %s: %ld wins, %ld ties, %ld losses, %.2f points on average\n", i + 1,
+           job.strategies_[standing->strategy_index_]->name_, standing->wins_, standing->ties_, standing->losses_,
+           standing->games_ > 0 ? (double)standing->points_ / standing->games_ : 0.0);
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function loads the decks of a tournament. The deck list holds one deck per line, either the path of a config
+/// file for two players or a seed line like in a config file, which generates the deck without any file. Empty lines
+/// are skipped.
+///
+/// @param deck_list_file The path to the deck list
+/// @param job The tournament, its decks are stored in it
+///
+/// @return
+///      0 if all decks were loaded
+///      2 if the deck list or a config file could not be opened
+///      3 if the deck list or a config file is invalid
+///      4 if there was a memory allocation error
+//
+int loadTournamentDecks(const char *deck_list_file, TournamentJob *job)
+{
+  job->decks_ = NULL;
+  job->decks_count_ = 0;
+  FILE *file = openFile((char *)deck_list_file);
+  if (file == NULL)
+  {
+    return CANNOT_OPEN_FILE;
+  }
+  size_t length = 0;
+  char *content = readConfigFile(file, NULL, 0, INT_MAX, &length);
+  fclose(file);
+  file = NULL;
+  if (content == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  // Count the decks first, so the decks are allocated at once and never move
+  int lines_count = 1;
+  for (const char *newline = content; (newline = memchr(newline, '\n', content + length - newline)) != NULL;
+       newline++)
+  {
+    lines_count++;
+  }
+  job->decks_ = calloc(lines_count, sizeof(TournamentDeck));
+  if (job->decks_ == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    free(content);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  char *cursor = content;
+  const char *end = content + length;
+  char *line;
+  int error = 0;
+  while (error == 0 && (line = nextConfigLine(&cursor, end)) != NULL)
+  {
+    if (line[0] == '\0')
+    {
+      continue;
+    }
+    TournamentDeck *deck = &job->decks_[job->decks_count_];
+    if (initCardArena(&deck->arena_, DECK_SIZE) != 0)
+    {
+      printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+      error = MEMORY_ALLOCATION_ERROR;
+      break;
+    }
+    job->decks_count_++;
+    uint64_t seed = 0;
+    int players_count = MIN_PLAYERS;
+    if (parseDeckSeed(line, &seed))
+    {
+      error = generateDeck(&deck->arena_, seed, MIN_PLAYERS, deck->players_);
+    }
+    else
+    {
+      error = loadConfigFile(line, &deck->arena_, &players_count, deck->players_, MIN_PLAYERS);
+    }
+    if (error == 0)
+    {
+      deck->deck_hash_ = hashDeck(deck->players_, MIN_PLAYERS);
+    }
+  }
+  free(content);
+  if (error == 0 && job->decks_count_ == 0)
+  {
+    printf("Error: Invalid file: %s\n", deck_list_file);
+    error = INVALID_FILE;
+  }
+  if (error != 0)
+  {
+    freeTournamentDecks(job);
+  }
+  return error;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function frees the decks of a tournament.
+///
+/// @param job The tournament
+///
+/// @return void
+//
+void freeTournamentDecks(TournamentJob *job)
+{
+  for (int i = 0; i < job->decks_count_; i++)
+  {
+    freeCardArena(&job->decks_[i].arena_);
+  }
+  free(job->decks_);
+  job->decks_ = NULL;
+  job->decks_count_ = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This is the entry point of a tournament thread. It plays chunks of games from its own range, and when the range is
+/// empty it steals games from the other workers, until no worker has any games left. The thread reuses one card arena
+/// for all of its games and collects the standings of its own games and the records for the results journal in its
+/// own batch.
+///
+/// @param argument The TournamentWorker of this thread
+///
+/// @return NULL
+//
+void *tournamentWorker(void *argument)
+{
+  TournamentWorker *worker = argument;
+  if (initCardArena(&worker->arena_, DECK_SIZE) != 0)
+  {
+    worker->error_ = MEMORY_ALLOCATION_ERROR;
+    return NULL;
+  }
+  long first_game = 0;
+  long last_game = 0;
+  // A worker that stole games takes them from its own range again
+  while (worker->error_ == 0 &&
+         (takeTournamentGames(worker, &first_game, &last_game) ||
+          (stealTournamentGames(worker) && takeTournamentGames(worker, &first_game, &last_game))))
+  {
+    for (long game = first_game; game < last_game; game++)
+    {
+      if (playTournamentGame(worker, game) != 0)
+      {
+        worker->error_ = MEMORY_ALLOCATION_ERROR;
+        break;
+      }
+    }
+  }
+  flushJournalBatch(&results_journal, &worker->journal_batch_, TRUE);
+  freeCardArena(&worker->arena_);
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function takes the next chunk of games from the beginning of the range of a worker.
+///
+/// @param worker The worker that takes the games
+/// @param first_game Output parameter for the number of the first game of the chunk
+/// @param last_game Output parameter for the number behind the last game of the chunk
+///
+/// @return
+///      TRUE if there were games left in the range
+///      FALSE if the range is empty
+//
+int takeTournamentGames(TournamentWorker *worker, long *first_game, long *last_game)
+{
+  GameRange *range = &worker->range_;
+  pthread_mutex_lock(&range->mutex_);
+  *first_game = range->begin_;
+  *last_game = range->end_ - range->begin_ > TOURNAMENT_CHUNK_SIZE ? range->begin_ + TOURNAMENT_CHUNK_SIZE
+                                                                   : range->end_;
+  range->begin_ = *last_game;
+  pthread_mutex_unlock(&range->mutex_);
+  return *first_game < *last_game;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function steals games for a worker whose range is empty. The other workers are visited in turn starting with
+/// the next one, and the second half of the first range that still holds games becomes the range of the worker. Games
+/// are never added to a range, so when no worker has any games left the tournament is over.
+///
+/// @param worker The worker that steals the games
+///
+/// @return
+///      TRUE if games were stolen
+///      FALSE if no worker has any games left
+//
+int stealTournamentGames(TournamentWorker *worker)
+{
+  TournamentJob *job = worker->job_;
+  for (long i = 1; i < job->workers_count_; i++)
+  {
+    GameRange *victim = &job->workers_[(worker->index_ + i) % job->workers_count_].range_;
+    pthread_mutex_lock(&victim->mutex_);
+    long games_left = victim->end_ - victim->begin_;
+    if (games_left > 0)
+    {
+      // A single game that is left is taken as a whole
+      long middle = victim->begin_ + games_left / 2;
+      long stolen_end = victim->end_;
+      victim->end_ = middle;
+      pthread_mutex_unlock(&victim->mutex_);
+      pthread_mutex_lock(&worker->range_.mutex_);
+      worker->range_.begin_ = middle;
+      worker->range_.end_ = stolen_end;
+      pthread_mutex_unlock(&worker->range_.mutex_);
+      worker->stolen_games_ += stolen_end - middle;
+      return TRUE;
+    }
+    pthread_mutex_unlock(&victim->mutex_);
+  }
+  return FALSE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function plays one game of a tournament and adds its result to the standings of the worker, and to the results
+/// journal if one is open. The number of the game selects the deck, the pair of strategies and the random seed of the
+/// game.
+///
+/// @param worker The worker that plays the game
+/// @param game The number of the game
+///
+/// @return
+///      0 if the game could be played
+///      4 if there was a memory allocation error
+//
+int playTournamentGame(TournamentWorker *worker, long game)
+{
+  const TournamentJob *job = worker->job_;
+  long pairing = game / job->games_per_pairing_ % job->pairings_count_;
+  long deck = game / job->games_per_pairing_ / job->pairings_count_;
+  // The ordered pairs of different strategies are numbered row by row, leaving out the pairs of a strategy with itself
+  int strategy_indices[2];
+  strategy_indices[0] = (int)(pairing / (job->strategies_count_ - 1));
+  strategy_indices[1] = (int)(pairing % (job->strategies_count_ - 1));
+  if (strategy_indices[1] >= strategy_indices[0])
+  {
+    strategy_indices[1]++;
+  }
+  const Strategy *strategies[2] = {job->strategies_[strategy_indices[0]], job->strategies_[strategy_indices[1]]};
+  uint64_t random_state = (uint64_t)game;
+  int points[2];
+  long long start_ns = results_journal.fd_ >= 0 ? getMonotonicTimeNs() : 0;
+  if (simulateGame(&worker->arena_, job->decks_[deck].players_, strategies, &random_state, points) != 0)
+  {
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  if (results_journal.fd_ >= 0)
+  {
+    JournalRecord record;
+    fillJournalRecord(&record, job->decks_[deck].deck_hash_, points, 2, start_ns);
+    addJournalRecord(&results_journal, &worker->journal_batch_, &record);
+  }
+  for (int i = 0; i < 2; i++)
+  {
+    TournamentStanding *standing = &worker->standings_[strategy_indices[i]];
+    standing->games_++;
+    standing->points_ += points[i];
+    if (points[i] > points[1 - i])
+    {
+      standing->wins_++;
+    }
+    else if (points[i] < points[1 - i])
+    {
+      standing->losses_++;
+    }
+    else
+    {
+      standing->ties_++;
+    }
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function for qsort that orders the standings of two strategies. A win counts two and a tie one, on equal
+/// scores more points on average come first, and then the strategy that was given first.
+///
+/// @param first The first standing
+/// @param second The second standing
+///
+/// @return
+///      a negative value if the first standing comes first
+///      a positive value if the second standing comes first
+//
+int compareTournamentStandings(const void *first, const void *second)
+{
+  const TournamentStanding *first_standing = first;
+  const TournamentStanding *second_standing = second;
+  long first_score = 2 * first_standing->wins_ + first_standing->ties_;
+  long second_score = 2 * second_standing->wins_ + second_standing->ties_;
+  if (first_score != second_score)
+  {
+    return first_score > second_score ? -1 : 1;
+  }
+  // Cross multiplied, so the averages are compared without rounding
+  long long first_points = first_standing->points_ * (second_standing->games_ > 0 ? second_standing->games_ : 1);
+  long long second_points = second_standing->points_ * (first_standing->games_ > 0 ? first_standing->games_ : 1);
+  if (first_points != second_points)
+  {
+    return first_points > second_points ? -1 : 1;
+  }
+  return first_standing->strategy_index_ - second_standing->strategy_index_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function plays a complete game without any input or output. It follows the same rounds as the interactive
+/// game, but all decisions are taken by the given strategies. The points of both players are stored in points.
+///
+/// @param arena The arena for the cards of this game, it is reset before the game starts
+/// @param deck_players Both players with the sorted hand cards they start with, which are copied for this game
+/// @param strategies The strategies of both players
+/// @param random_state The state of the random number generator of this game
+/// @param points Output parameter for the points of both players
+///
+/// @return
+///      0 if the game could be played
+///      4 if there was a memory allocation error
+//
+int simulateGame(CardArena *arena, const Player *deck_players, const Strategy *const *strategies,
+                 uint64_t *random_state, int *points)
+{
+  Player players[2];
+  if (copyDeckPlayers(arena, deck_players, players) != 0)
+  {
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  playRemainingGame(players, strategies, PHASE_CHOOSING, 0, random_state);
+  points[0] = calculatePlayerPoints(players[0].cardrows_);
+  points[1] = calculatePlayerPoints(players[1].cardrows_);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function sets up both players for a new game with copies of the hand cards they start with. The arena is reset
+/// first, so the cards of the previous game are dropped at once.
+///
+/// @param arena The arena for the cards of the new game
+/// @param deck_players Both players with the sorted hand cards they start with
+/// @param players Output parameter for both players of the new game
+///
+/// @return
+///      0 if the players could be set up
+///      4 if there was a memory allocation error
+//
+int copyDeckPlayers(CardArena *arena, const Player *deck_players, Player *players)
+{
+  resetCardArena(arena);
+  for (int i = 0; i < 2; i++)
+  {
+    initPlayer(&players[i], i + 1);
+    if (copyCardList(arena, deck_players[i].handcards_, &players[i].handcards_) != 0)
+    {
+      return MEMORY_ALLOCATION_ERROR;
+    }
+    indexHandCards(&players[i]);
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function plays a game from the given point to its end, with all decisions taken by the given strategies. The
+/// game continues with the given phase and player, a player that has already chosen some of his cards only chooses
+/// the rest of them. The rounds are the same as in the interactive game.
+///
+/// @param players Both players in the state the game is continued from
+/// @param strategies The strategies of both players
+/// @param phase The phase the game is continued in
+/// @param first_player The index of the player that continues the phase
+/// @param random_state The state of the random number generator of this game
+///
+/// @return void
+//
+void playRemainingGame(Player *players, const Strategy *const *strategies, GamePhase phase, int first_player,
+                       uint64_t *random_state)
+{
+  do
+  {
+    if (phase == PHASE_CHOOSING)
+    {
+      for (int i = first_player; i < 2; i++)
+      {
+        while (countCards(players[i].chosencards_) < CARDS_TO_KEEP && players[i].handcards_ != NULL)
+        {
+          simulateChooseCard(&players[i], &players[1 - i], strategies[i], random_state);
+        }
+      }
+      exchangePlayerCards(&players[0], &players[1]);
+      first_player = 0;
+    }
+    for (int i = first_player; i < 2; i++)
+    {
+      while (players[i].chosencards_ != NULL)
+      {
+        simulateAction(&players[i], &players[1 - i], strategies[i], random_state);
+      }
+    }
+    phase = PHASE_CHOOSING;
+    first_player = 0;
+  } while ((players[0].handcards_ != NULL || players[0].chosencards_ != NULL) &&
+           (players[1].handcards_ != NULL || players[1].chosencards_ != NULL));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function counts the cards of a list.
+///
+/// @param head The head of the list
+///
+/// @return
+///      the number of cards
+//
+int countCards(const Card *head)
+{
+  int cards_count = 0;
+  for (; head != NULL; head = head->next_)
+  {
+    cards_count++;
+  }
+  return cards_count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function lets a strategy choose a hand card to keep and moves it to the chosen cards. If the strategy returns
+/// a card that is not in the hand cards, the first hand card is kept instead.
+///
+/// @param player The player that chooses a card
+/// @param opponent The other player
+/// @param strategy The strategy of the player
+/// @param random_state The state of the random number generator
+///
+/// @return void
+//
+void simulateChooseCard(Player *player, const Player *opponent, const Strategy *strategy, uint64_t *random_state)
+{
+  Card *card = askStrategyForCard(strategy, player, opponent, random_state);
+  if (card == NULL || getCardFromHand(player, card->value_) != card)
+  {
+    card = player->handcards_;
+  }
+  removeCardFromHand(player, card);
+  addCardToChosen(player, card);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function lets a strategy choose a place or discard action for one chosen card and performs it. A card that
+/// cannot extend the row the strategy picked is discarded, and so is the first chosen card if the strategy returns a
+/// card that is not one of the chosen cards.
+///
+/// @param player The player that performs the action
+/// @param opponent The other player
+/// @param strategy The strategy of the player
+/// @param random_state The state of the random number generator
+///
+/// @return void
+//
+void simulateAction(Player *player, const Player *opponent, const Strategy *strategy, uint64_t *random_state)
+{
+  int row_number = -1;
+  Card *card = askStrategyForAction(strategy, player, opponent, &row_number, random_state);
+  if (card == NULL || getCardFromChosen(player, card->value_) != card)
+  {
+    card = player->chosencards_;
+    row_number = -1;
+  }
+  removeCardFromChosen(player, card);
+  if (row_number >= 0 && row_number < MAX_CARD_ROWS)
+  {
+    // A card that does not fit stays unlinked, which discards it
+    addCardToRow(player, card, row_number);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function looks up a strategy by its name, the built-in strategies first and then those loaded from plugins.
+///
+/// @param name The name of the strategy
+///
+/// @return
+///      NULL if there is no strategy with this name
+///      a pointer to the strategy otherwise
+//
+const Strategy *findStrategy(const char *name)
+{
+  for (int i = 0; i < STRATEGIES_COUNT; i++)
+  {
+    if (strcmp(STRATEGIES[i].name_, name) == 0)
+    {
+      return &STRATEGIES[i];
+    }
+  }
+  for (int i = 0; i < plugin_strategies_count; i++)
+  {
+    if (strcmp(plugin_strategies[i].name_, name) == 0)
+    {
+      return &plugin_strategies[i];
+    }
+  }
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function loads a strategy plugin from a shared object and adds it to the strategies that can be selected by
+/// name. The shared object stays loaded until the program ends.
+///
+/// @param plugin_file The path to the shared object
+///
+/// @return
+///      0 if the plugin was loaded
+///      2 if the shared object could not be loaded or is no strategy plugin
+//
+int loadStrategyPlugin(const char *plugin_file)
+{
+  if (plugin_strategies_count >= MAX_STRATEGY_PLUGINS)
+  {
+    printf("Error: Cannot load plugin: %s\n", plugin_file);
+    return CANNOT_OPEN_FILE;
+  }
+  void *handle = dlopen(plugin_file, RTLD_NOW | RTLD_LOCAL);
+  void *symbol = handle != NULL ? dlsym(handle, STRATEGY_PLUGIN_ENTRY) : NULL;
+  // ISO C has no conversion from an object pointer to a function pointer, so the address is copied instead
+  StrategyPluginEntry entry = NULL;
+  if (symbol != NULL)
+  {
+    memcpy(&entry, &symbol, sizeof(entry));
+  }
+  const StrategyPlugin *plugin = entry != NULL ? entry() : NULL;
+  if (plugin == NULL || plugin->api_version_ != STRATEGY_PLUGIN_API_VERSION || plugin->name_ == NULL ||
+      plugin->chooseCard_ == NULL || plugin->chooseAction_ == NULL)
+  {
+    printf("Error: Cannot load plugin: %s\n", plugin_file);
+    if (handle != NULL)
+    {
+      dlclose(handle);
+    }
+    return CANNOT_OPEN_FILE;
+  }
+  Strategy *strategy = &plugin_strategies[plugin_strategies_count++];
+  strategy->name_ = plugin->name_;
+  strategy->chooseCard_ = NULL;
+  strategy->chooseAction_ = NULL;
+  strategy->plugin_ = plugin;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function asks a strategy for the hand card a player keeps. A plugin gets a view of the game and answers with
+/// the value of the card.
+///
+/// @param strategy The strategy of the player
+/// @param player The player that chooses a card
+/// @param opponent The other player
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      NULL if the strategy chose no hand card
+///      a pointer to the hand card otherwise
+//
+Card *askStrategyForCard(const Strategy *strategy, const Player *player, const Player *opponent,
+                         uint64_t *random_state)
+{
+  if (strategy->plugin_ == NULL)
+  {
+    return strategy->chooseCard_(player, opponent, random_state);
+  }
+  StrategyView view;
+  StrategyCard cards[MAX_DECK_SIZE];
+  fillStrategyView(&view, cards, player, opponent);
+  return getCardFromHand(player, strategy->plugin_->chooseCard_(&view, random_state));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function asks a strategy for the next action of a player. A plugin gets a view of the game and answers with
+/// the value of the card and the row.
+///
+/// @param strategy The strategy of the player
+/// @param player The player that performs the action
+/// @param opponent The other player
+/// @param row_number Output parameter for the index of the row, -1 to discard the card
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      NULL if the strategy chose no chosen card
+///      a pointer to the chosen card otherwise
+//
+Card *askStrategyForAction(const Strategy *strategy, const Player *player, const Player *opponent, int *row_number,
+                           uint64_t *random_state)
+{
+  if (strategy->plugin_ == NULL)
+  {
+    return strategy->chooseAction_(player, opponent, row_number, random_state);
+  }
+  StrategyView view;
+  StrategyCard cards[MAX_DECK_SIZE];
+  fillStrategyView(&view, cards, player, opponent);
+  *row_number = -1;
+  return getCardFromChosen(player, strategy->plugin_->chooseAction_(&view, row_number, random_state));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function fills the view of the game a plugin decides on. It shows the cards of the player and the rows of the
+/// opponent, the hand and chosen cards of the opponent stay hidden. All lists share the given array of cards.
+///
+/// @param view The view to fill
+/// @param cards The cards the lists of the view point into, it has to hold MAX_DECK_SIZE cards
+/// @param player The player that decides
+/// @param opponent The other player
+///
+/// @return void
+//
+void fillStrategyView(StrategyView *view, StrategyCard *cards, const Player *player, const Player *opponent)
+{
+  int cards_count = 0;
+  view->player_id_ = player->id_;
+  fillStrategyCardList(&view->handcards_, cards, &cards_count, player->handcards_);
+  fillStrategyCardList(&view->chosencards_, cards, &cards_count, player->chosencards_);
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    fillStrategyCardList(&view->cardrows_[i], cards, &cards_count, player->cardrows_[i].head_);
+    fillStrategyCardList(&view->opponent_cardrows_[i], cards, &cards_count, opponent->cardrows_[i].head_);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function to copy a list of cards to the end of the cards of a view.
+///
+/// @param list Output parameter for the copied list
+/// @param cards The cards of the view
+/// @param cards_count The number of cards of the view, it is increased by the number of copied cards
+/// @param head The head of the list to copy
+///
+/// @return void
+//
+void fillStrategyCardList(StrategyCardList *list, StrategyCard *cards, int *cards_count, const Card *head)
+{
+  list->cards_ = cards + *cards_count;
+  list->count_ = 0;
+  for (; head != NULL && *cards_count < MAX_DECK_SIZE; head = head->next_)
+  {
+    cards[*cards_count].value_ = head->value_;
+    cards[*cards_count].color_ = (char)head->color_;
+    (*cards_count)++;
+    list->count_++;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns the next number of a SplitMix64 random number generator.
+///
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the next random number
+//
+uint64_t nextRandom(uint64_t *random_state)
+{
+  uint64_t z = (*random_state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns a random number between 0 (inclusive) and bound (exclusive).
+///
+/// @param random_state The state of the random number generator
+/// @param bound The upper bound, must be greater than 0
+///
+/// @return
+///      the random number
+//
+int randomBelow(uint64_t *random_state, int bound)
+{
+  return (int)(nextRandom(random_state) % (uint64_t)bound);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function picks a random card from a non-empty list of cards.
+///
+/// @param head The head of the list
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the random card
+//
+Card *getRandomCard(Card *head, uint64_t *random_state)
+{
+  for (int i = randomBelow(random_state, countCards(head)); i > 0; i--)
+  {
+    head = head->next_;
+  }
+  return head;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The random strategy keeps a random hand card.
+///
+/// @param player The player that chooses a card
+/// @param opponent The other player
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to keep
+//
+Card *chooseRandomCard(const Player *player, const Player *opponent, uint64_t *random_state)
+{
+  (void)opponent;
+  return getRandomCard(player->handcards_, random_state);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The random strategy takes a random chosen card and places it on a random row it can extend. If there is no such
+/// row, the card is discarded.
+///
+/// @param player The player that performs the action
+/// @param opponent The other player
+/// @param row_number Output parameter for the row index, -1 to discard the card
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to place or discard
+//
+Card *chooseRandomAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state)
+{
+  (void)opponent;
+  Card *card = getRandomCard(player->chosencards_, random_state);
+  int fitting_rows[MAX_CARD_ROWS];
+  int fitting_rows_count = 0;
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    if (canCardExtendRow(&player->cardrows_[i], card))
+    {
+      fitting_rows[fitting_rows_count++] = i;
+    }
+  }
+  *row_number = fitting_rows_count > 0 ? fitting_rows[randomBelow(random_state, fitting_rows_count)] : -1;
+  return card;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The greedy strategy keeps the hand card with the most points that can still extend one of the rows. If no hand
+/// card fits, the first hand card is kept.
+///
+/// @param player The player that chooses a card
+/// @param opponent The other player
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to keep
+//
+Card *chooseGreedyCard(const Player *player, const Player *opponent, uint64_t *random_state)
+{
+  (void)opponent;
+  (void)random_state;
+  Card *best_card = player->handcards_;
+  int best_points = -1;
+  for (Card *card = player->handcards_; card != NULL; card = card->next_)
+  {
+    int fits = FALSE;
+    for (int i = 0; i < MAX_CARD_ROWS && !fits; i++)
+    {
+      fits = canCardExtendRow(&player->cardrows_[i], card);
+    }
+    int points = fits ? getCardPoints(card) : 0;
+    if (points > best_points)
+    {
+      best_card = card;
+      best_points = points;
+    }
+  }
+  return best_card;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The greedy strategy places the chosen card with the most points on the row where it leaves the smallest gap to the
+/// end it extends. Empty rows are only used if the card does not fit any started row. If no chosen card fits anywhere,
+/// the chosen card with the fewest points is discarded.
+///
+/// @param player The player that performs the action
+/// @param opponent The other player
+/// @param row_number Output parameter for the row index, -1 to discard the card
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to place or discard
+//
+Card *chooseGreedyAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state)
+{
+  (void)opponent;
+  (void)random_state;
+  Card *best_card = NULL;
+  int best_points = -1;
+  int best_gap = INT_MAX;
+  Card *worst_card = player->chosencards_;
+  *row_number = -1;
+  for (Card *card = player->chosencards_; card != NULL; card = card->next_)
+  {
+    if (getCardPoints(card) < getCardPoints(worst_card))
+    {
+      worst_card = card;
+    }
+    for (int i = 0; i < MAX_CARD_ROWS; i++)
+    {
+      const CardRow *row = &player->cardrows_[i];
+      if (!canCardExtendRow(row, card))
+      {
+        continue;
+      }
+      int gap = INT_MAX - 1;
+      if (row->head_ != NULL)
+      {
+        gap = card->value_ < row->min_value_ ? row->min_value_ - card->value_ : card->value_ - row->max_value_;
+      }
+      int points = getCardPoints(card);
+      if (points > best_points || (points == best_points && gap < best_gap))
+      {
+        best_card = card;
+        best_points = points;
+        best_gap = gap;
+        *row_number = i;
+      }
+    }
+  }
+  return best_card != NULL ? best_card : worst_card;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The playout strategy is used by the search to play games to their end. It keeps a card like the greedy or like the
+/// random strategy, each with the same chance, so that the playouts are fast but still varied and reasonable.
+///
+/// @param player The player that chooses a card
+/// @param opponent The other player
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to keep
+//
+Card *choosePlayoutCard(const Player *player, const Player *opponent, uint64_t *random_state)
+{
+  if (nextRandom(random_state) & 1)
+  {
+    return chooseGreedyCard(player, opponent, random_state);
+  }
+  return chooseRandomCard(player, opponent, random_state);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The playout strategy performs an action like the greedy or like the random strategy, each with the same chance.
+///
+/// @param player The player that performs the action
+/// @param opponent The other player
+/// @param row_number Output parameter for the row index, -1 to discard the card
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to place or discard
+//
+Card *choosePlayoutAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state)
+{
+  if (nextRandom(random_state) & 1)
+  {
+    return chooseGreedyAction(player, opponent, row_number, random_state);
+  }
+  return chooseRandomAction(player, opponent, row_number, random_state);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The search strategy keeps the card the Monte Carlo search recommends. If the search fails, it keeps the card the
+/// greedy strategy would keep.
+///
+/// @param player The player that chooses a card
+/// @param opponent The other player
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to keep
+//
+Card *chooseSearchCard(const Player *player, const Player *opponent, uint64_t *random_state)
+{
+  SearchMove move;
+  if (searchBestMove(player, opponent, PHASE_CHOOSING, &move) != 0)
+  {
+    return chooseGreedyCard(player, opponent, random_state);
+  }
+  return getCardFromHand(player, move.values_[0]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// The search strategy performs the action the Monte Carlo search recommends. If the search fails, it performs the
+/// action the greedy strategy would perform.
+///
+/// @param player The player that performs the action
+/// @param opponent The other player
+/// @param row_number Output parameter for the row index, -1 to discard the card
+/// @param random_state The state of the random number generator
+///
+/// @return
+///      the card to place or discard
+//
+Card *chooseSearchAction(const Player *player, const Player *opponent, int *row_number, uint64_t *random_state)
+{
+  SearchMove move;
+  if (searchBestMove(player, opponent, PHASE_ACTION, &move) != 0)
+  {
+    return chooseGreedyAction(player, opponent, row_number, random_state);
+  }
+  *row_number = move.row_number_;
+  return getCardFromChosen(player, move.values_[0]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function searches for the best move of a player with a Monte Carlo search. Every possible move is played out
+/// many times from copies of the current game, with the rest of the game decided by the playout strategy for both
+/// players. The search only uses what the player can see: the cards of the opponent he has not seen are dealt anew
+/// from the unseen values in every playout. The moves to play out are selected with UCB1. All cores search in
+/// parallel until the time of a move is up, then the statistics of all threads are added up and the move that was
+/// played out most often is the best one.
+///
+/// @param player The player to search a move for, he must have a card to choose or a chosen card to play
+/// @param opponent The other player
+/// @param phase The phase the game is in
+/// @param best_move Output parameter for the best move
+///
+/// @return
+///      0 if a move was found
+///      4 if there was a memory allocation error
+//
+int searchBestMove(const Player *player, const Player *opponent, GamePhase phase, SearchMove *best_move)
+{
+  SearchJob job;
+  // The search plays the player against the opponent alone, whoever has the lower id acts first in every phase
+  job.player_index_ = player->id_ < opponent->id_ ? 0 : 1;
+  job.players_[job.player_index_] = player;
+  job.players_[1 - job.player_index_] = opponent;
+  job.phase_ = phase;
+  // The first cards to keep are looked up in the opening book, which saves the search
+  if (phase == PHASE_CHOOSING && probeOpeningBook(&opening_book, player, best_move))
+  {
+    return 0;
+  }
+  job.cards_count_ = 0;
+  for (int i = 0; i < 2; i++)
+  {
+    job.cards_count_ += countCards(job.players_[i]->handcards_) + countCards(job.players_[i]->chosencards_);
+    for (int j = 0; j < MAX_CARD_ROWS; j++)
+    {
+      job.cards_count_ += job.players_[i]->cardrows_[j].length_;
+    }
+  }
+  generateSearchMoves(&job);
+  *best_move = job.moves_[0];
+  if (job.moves_count_ == 1)
+  {
+    return 0;
+  }
+  job.hide_opponent_hand_ = isOpponentHandHidden(player, phase);
+  job.unseen_count_ = collectUnseenValues(player, opponent, job.hide_opponent_hand_, job.unseen_values_);
+  long threads_count = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads_count < 1)
+  {
+    threads_count = 1;
+  }
+  if (threads_count > MAX_SEARCH_THREADS)
+  {
+    threads_count = MAX_SEARCH_THREADS;
+  }
+  SearchWorker *workers = calloc(threads_count, sizeof(SearchWorker));
+  if (workers == NULL)
+  {
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  uint64_t seed = (uint64_t)getMonotonicTimeNs();
+  job.deadline_ns_ = getMonotonicTimeNs() + search_time_ms * 1000000LL;
+  for (long i = 0; i < threads_count; i++)
+  {
+    workers[i].job_ = &job;
+    workers[i].random_state_ = seed + (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+  }
+  long started_count = 0;
+  // A single thread searches on the calling thread, which saves starting one
+  for (long i = 0; i < threads_count && threads_count > 1; i++)
+  {
+    if (pthread_create(&workers[i].thread_, NULL, searchWorker, &workers[i]) != 0)
+    {
+      break;
+    }
+    started_count++;
+  }
+  for (long i = 0; i < started_count; i++)
+  {
+    pthread_join(workers[i].thread_, NULL);
+  }
+  if (started_count == 0)
+  {
+    searchWorker(&workers[0]);
+    started_count = 1;
+  }
+  long best_visits = -1;
+  int error = 0;
+  for (int move = 0; move < job.moves_count_; move++)
+  {
+    long visits = 0;
+    for (long i = 0; i < started_count; i++)
+    {
+      visits += workers[i].visits_[move];
+    }
+    if (visits > best_visits)
+    {
+      best_visits = visits;
+      *best_move = job.moves_[move];
+    }
+  }
+  for (long i = 0; i < started_count; i++)
+  {
+    error |= workers[i].error_;
+  }
+  free(workers);
+  return error != 0 ? MEMORY_ALLOCATION_ERROR : 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function lists the moves of the searching player. In the choosing phase a move keeps all cards the player
+/// still has to choose at once, as long as there are not too many combinations, otherwise it keeps a single card. In
+/// the action phase a move places a chosen card on a row it can extend or discards it. Empty rows are not alike, as
+/// the longest row doubles the points of all rows before it as well.
+///
+/// @param job The search job with the players and the phase, its moves are filled in
+///
+/// @return void
+//
+void generateSearchMoves(SearchJob *job)
+{
+  const Player *player = job->players_[job->player_index_];
+  job->moves_count_ = 0;
+  if (job->phase_ == PHASE_CHOOSING)
+  {
+    int cards_count = countCards(player->handcards_);
+    int keep_pairs = CARDS_TO_KEEP - countCards(player->chosencards_) >= 2 && cards_count >= 2 &&
+                     cards_count * (cards_count - 1) / 2 <= MAX_SEARCH_MOVES;
+    for (Card *card = player->handcards_; card != NULL && job->moves_count_ < MAX_SEARCH_MOVES; card = card->next_)
+    {
+      if (!keep_pairs)
+      {
+        SearchMove move = {{card->value_, 0}, 1, -1};
+        job->moves_[job->moves_count_++] = move;
+        continue;
+      }
+      for (Card *other = card->next_; other != NULL; other = other->next_)
+      {
+        SearchMove move = {{card->value_, other->value_}, 2, -1};
+        job->moves_[job->moves_count_++] = move;
+      }
+    }
+    return;
+  }
+  for (Card *card = player->chosencards_; card != NULL; card = card->next_)
+  {
+    for (int i = -1; i < MAX_CARD_ROWS && job->moves_count_ < MAX_SEARCH_MOVES; i++)
+    {
+      if (i < 0 || canCardExtendRow(&player->cardrows_[i], card))
+      {
+        SearchMove move = {{card->value_, 0}, 1, i};
+        job->moves_[job->moves_count_++] = move;
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This is the entry point of a search thread. It plays out the moves of the job until the time is up, but every move
+/// at least once. The clock is only read every few playouts.
+///
+/// @param argument The SearchWorker of this thread
+///
+/// @return NULL
+//
+void *searchWorker(void *argument)
+{
+  SearchWorker *worker = argument;
+  const SearchJob *job = worker->job_;
+  if (initCardArena(&worker->arena_, job->cards_count_) != 0)
+  {
+    worker->error_ = MEMORY_ALLOCATION_ERROR;
+    return NULL;
+  }
+  // Every playout shuffles the unseen values in place, so each thread has its own copy
+  memcpy(worker->unseen_values_, job->unseen_values_, sizeof(worker->unseen_values_));
+  for (long iteration = 0; worker->error_ == 0; iteration++)
+  {
+    if (iteration >= job->moves_count_ && iteration % SEARCH_CLOCK_INTERVAL == 0 &&
+        getMonotonicTimeNs() >= job->deadline_ns_)
+    {
+      break;
+    }
+    int move = selectSearchMove(worker, iteration);
+    double reward;
+    if (runPlayout(worker, &job->moves_[move], &reward) != 0)
+    {
+      worker->error_ = MEMORY_ALLOCATION_ERROR;
+      break;
+    }
+    worker->visits_[move]++;
+    worker->rewards_[move] += reward;
+  }
+  freeCardArena(&worker->arena_);
+  return NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function selects the next move to play out with UCB1: moves that were not played out yet come first, then
+/// the move with the highest average reward plus a bonus that is larger the less often it was played out. The
+/// logarithm in the bonus is a binary one, which only changes its constant factor.
+///
+/// @param worker The search thread with its statistics
+/// @param total_visits The number of playouts of this thread so far
+///
+/// @return
+///      the index of the move to play out
+//
+int selectSearchMove(const SearchWorker *worker, long total_visits)
+{
+  int best_move = 0;
+  double best_value = -1;
+  double logarithm = binaryLogarithm(total_visits);
+  for (int move = 0; move < worker->job_->moves_count_; move++)
+  {
+    if (worker->visits_[move] == 0)
+    {
+      return move;
+    }
+    double value = worker->rewards_[move] / worker->visits_[move] +
+                   SEARCH_EXPLORATION * squareRoot(logarithm / worker->visits_[move]);
+    if (value > best_value)
+    {
+      best_value = value;
+      best_move = move;
+    }
+  }
+  return best_move;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function plays out a move once. Both players are copied into the arena of the search thread and the cards of
+/// the opponent that the searching player cannot see are dealt anew. Then the move is applied and the game is played
+/// to its end by the playout strategy. A win of the searching player is worth 1, a tie 0.5 and a loss 0.
+///
+/// @param worker The search thread
+/// @param move The move to play out
+/// @param reward Output parameter for the reward of the playout
+///
+/// @return
+///      0 if the move was played out
+///      4 if there was a memory allocation error
+//
+int runPlayout(SearchWorker *worker, const SearchMove *move, double *reward)
+{
+  const SearchJob *job = worker->job_;
+  const Strategy *strategies[2] = {&PLAYOUT_STRATEGY, &PLAYOUT_STRATEGY};
+  Player players[2];
+  resetCardArena(&worker->arena_);
+  for (int i = 0; i < 2; i++)
+  {
+    if (copyPlayer(&worker->arena_, job->players_[i], &players[i]) != 0)
+    {
+      return MEMORY_ALLOCATION_ERROR;
+    }
+  }
+  dealHiddenCards(&players[1 - job->player_index_], job->hide_opponent_hand_, worker->unseen_values_,
+                  job->unseen_count_, &worker->random_state_);
+  applySearchMove(&players[job->player_index_], move, job->phase_);
+  playRemainingGame(players, strategies, job->phase_, job->player_index_, &worker->random_state_);
+  int points = calculatePlayerPoints(players[job->player_index_].cardrows_);
+  int opponent_points = calculatePlayerPoints(players[1 - job->player_index_].cardrows_);
+  *reward = 0;
+  if (points > opponent_points)
+  {
+    *reward = 1;
+  }
+  else if (points == opponent_points)
+  {
+    *reward = 0.5;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function applies a move to a copy of the searching player.
+///
+/// @param player The copy of the searching player
+/// @param move The move to apply
+/// @param phase The phase the move is made in
+///
+/// @return void
+//
+void applySearchMove(Player *player, const SearchMove *move, GamePhase phase)
+{
+  for (int i = 0; i < move->values_count_; i++)
+  {
+    if (phase == PHASE_CHOOSING)
+    {
+      Card *card = getCardFromHand(player, move->values_[i]);
+      removeCardFromHand(player, card);
+      addCardToChosen(player, card);
+    }
+    else
+    {
+      Card *card = getCardFromChosen(player, move->values_[i]);
+      removeCardFromChosen(player, card);
+      if (move->row_number_ >= 0)
+      {
+        addCardToRow(player, card, move->row_number_);
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function tells whether a player has not seen the hand cards of his opponent yet. In a game of two the hands
+/// are exchanged after every choosing phase, so the opponent holds the cards the player passed to him, except in the
+/// first choosing phase. That is the only time the player holds all HAND_SIZE cards he was dealt.
+///
+/// @param player The searching player
+/// @param phase The phase the game is in
+///
+/// @return
+///      TRUE if the hand cards of the opponent are hidden
+///      FALSE otherwise
+//
+int isOpponentHandHidden(const Player *player, GamePhase phase)
+{
+  return phase == PHASE_CHOOSING && countCards(player->handcards_) + countCards(player->chosencards_) == HAND_SIZE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function collects the card values a player has not seen: all values 1 to MAX_CARD_VALUE except his own cards,
+/// the rows of both players and, once they were passed to the opponent, the hand cards of the opponent. The chosen
+/// cards of the opponent are never seen before they are placed.
+///
+/// @param player The searching player
+/// @param opponent The other player
+/// @param hide_opponent_hand Whether the hand cards of the opponent are hidden
+/// @param unseen_values Output parameter for the unseen values, it has to hold MAX_CARD_VALUE values
+///
+/// @return
+///      the number of unseen values
+//
+int collectUnseenValues(const Player *player, const Player *opponent, int hide_opponent_hand, int *unseen_values)
+{
+  CardSet seen = player->handset_;
+  for (int word = 0; word < CARD_SET_WORDS; word++)
+  {
+    seen.words_[word] |= player->chosenset_.words_[word];
+    seen.words_[word] |= hide_opponent_hand ? 0 : opponent->handset_.words_[word];
+    for (int i = 0; i < MAX_CARD_ROWS; i++)
+    {
+      seen.words_[word] |= player->cardrows_[i].set_.words_[word] | opponent->cardrows_[i].set_.words_[word];
+    }
+  }
+  int unseen_count = 0;
+  for (int value = 1; value <= MAX_CARD_VALUE; value++)
+  {
+    if (!isInCardSet(&seen, value))
+    {
+      unseen_values[unseen_count++] = value;
+    }
+  }
+  return unseen_count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function deals the cards of a copied opponent that the searching player cannot see anew: his chosen cards and,
+/// if they are hidden, his hand cards. Every card gets a value drawn without replacement from the unseen values with a
+/// partial Fisher-Yates shuffle, which leaves the unseen values in a new order for the next deal, and a random color.
+/// The lists are sorted and indexed again afterwards.
+///
+/// @param opponent The copy of the opponent
+/// @param hide_hand Whether the hand cards of the opponent are dealt anew as well
+/// @param unseen_values The values the searching player has not seen, they are shuffled in place
+/// @param unseen_count The number of unseen values
+/// @param random_state The state of the random number generator
+///
+/// @return void
+//
+void dealHiddenCards(Player *opponent, int hide_hand, int *unseen_values, int unseen_count, uint64_t *random_state)
+{
+  Card *lists[2] = {opponent->chosencards_, hide_hand ? opponent->handcards_ : NULL};
+  int drawn_count = 0;
+  for (int list = 0; list < 2; list++)
+  {
+    for (Card *card = lists[list]; card != NULL && drawn_count < unseen_count; card = card->next_)
+    {
+      int drawn = drawn_count + randomBelow(random_state, unseen_count - drawn_count);
+      int value = unseen_values[drawn];
+      unseen_values[drawn] = unseen_values[drawn_count];
+      unseen_values[drawn_count++] = value;
+      card->value_ = value;
+      card->color_ = CARD_COLORS[randomBelow(random_state, COLORS_COUNT)];
+    }
+  }
+  memset(&opponent->chosenset_, 0, sizeof(opponent->chosenset_));
+  sortCards(&opponent->chosencards_);
+  for (const Card *card = opponent->chosencards_; card != NULL; card = card->next_)
+  {
+    addToCardSet(&opponent->chosenset_, card->value_);
+  }
+  if (hide_hand)
+  {
+    sortCards(&opponent->handcards_);
+    indexHandCards(opponent);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function copies a player with all of his cards into an arena.
+///
+/// @param arena The arena the cards are copied to
+/// @param source The player to copy
+/// @param copy The copy to fill in
+///
+/// @return
+///      0 if the player was copied
+///      4 if there was a memory allocation error
+//
+int copyPlayer(CardArena *arena, const Player *source, Player *copy)
+{
+  initPlayer(copy, source->id_);
+  copy->chosenset_ = source->chosenset_;
+  if (copyCardList(arena, source->handcards_, &copy->handcards_) != 0 ||
+      copyCardList(arena, source->chosencards_, &copy->chosencards_) != 0)
+  {
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  indexHandCards(copy);
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    // The running totals stay the same, only the cards of the row are new
+    CardRow *row = &copy->cardrows_[i];
+    *row = source->cardrows_[i];
+    if (copyCardList(arena, source->cardrows_[i].head_, &row->head_) != 0)
+    {
+      return MEMORY_ALLOCATION_ERROR;
+    }
+    row->tail_ = row->head_;
+    while (row->tail_ != NULL && row->tail_->next_ != NULL)
+    {
+      row->tail_ = row->tail_->next_;
+    }
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns the current time of a monotonic clock in nanoseconds.
+///
+/// @return
+///      the current time in nanoseconds
+//
+long long getMonotonicTimeNs(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function calculates a square root with Newton's method, so that the program does not need the math library.
+///
+/// @param value The value to take the square root of
+///
+/// @return
+///      the square root, 0 for values that are not positive
+//
+double squareRoot(double value)
+{
+  if (value <= 0)
+  {
+    return 0;
+  }
+  // Starting above the root, every step gets closer to it from above until it stops decreasing
+  double root = value > 1 ? value : 1;
+  while (TRUE)
+  {
+    double next = (root + value / root) / 2;
+    if (next >= root)
+    {
+      return root;
+    }
+    root = next;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns the number of binary digits of a value, which is its binary logarithm rounded down plus one.
+///
+/// @param value The value, should be positive
+///
+/// @return
+///      the number of binary digits, 0 for values that are not positive
+//
+int binaryLogarithm(long value)
+{
+  int digits = 0;
+  for (; value > 0; value >>= 1)
+  {
+    digits++;
+  }
+  return digits;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function runs the solve mode. The config file is loaded and the game is solved exactly from the moment the
+/// cards are dealt, as both players know the whole deck. The optimal result is the one where each player plays for the
+/// largest lead over the other one. The points of both players and one line of optimal play are printed, in the form
+/// of the commands the players would enter, in quiet mode without the line with the timing of the search. Nothing is
+/// written to the config file.
+///
+/// @param options The parsed command line options
+///
+/// @return
+///      0 if the game was solved
+///      2 if the config file could not be opened
+///      3 if the config file is invalid
+///      4 if there was a memory allocation error
+//
+int runSolver(const Options *options)
+{
+  int players_count = 0;
+  CardArena arena;
+  if (initCardArena(&arena, DECK_SIZE) != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  Player players[2];
+  int config_file_error = loadConfigFile(options->config_file_, &arena, &players_count, players, MIN_PLAYERS);
+  if (config_file_error != 0)
+  {
+    freeCardArena(&arena);
+    return config_file_error;
+  }
+  Solver solver;
+  SolverState state;
+  int solver_error = initSolver(&solver, players, &state);
+  freeCardArena(&arena);
+  if (solver_error != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  long long start_ns = getMonotonicTimeNs();
+  int value = solvePosition(&solver, &state, -INT_MAX, INT_MAX);
+  SolverMove line[MAX_SOLVER_LINE];
+  int line_length = findPrincipalVariation(&solver, &state, value, line);
+  double seconds = (getMonotonicTimeNs() - start_ns) / 1e9;
+  if (!options->quiet_)
+  {
+    printf("Solved %s in %.3f s (%lld positions, %lld table hits)\n", options->config_file_, seconds,
+           solver.positions_, solver.table_hits_);
+  }
+  printf("Player 1: %i points\n", calculateSolverRowsPoints(state.cardrows_[0]));
+  printf("Player 2: %i points\n", calculateSolverRowsPoints(state.cardrows_[1]));
+  printPrincipalVariation(&solver, line, line_length);
+  freeSolver(&solver);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function initializes a solver for the cards the players were dealt and sets up the position the game starts
+/// in. The cards of both players are numbered in ascending order of their values. The transposition table is
+/// allocated here.
+///
+/// @param solver The solver to initialize
+/// @param players Both players with the hand cards they were dealt
+/// @param state Output parameter for the position the game starts in
+///
+/// @return
+///      0 if the solver was initialized
+///      4 if there was a memory allocation error
+//
+int initSolver(Solver *solver, const Player *players, SolverState *state)
+{
+  memset(state, 0, sizeof(*state));
+  solver->deck_size_ = 0;
+  for (int i = 0; i < 2; i++)
+  {
+    for (Card *card = players[i].handcards_; card != NULL && solver->deck_size_ < MAX_SOLVER_CARDS; card = card->next_)
+    {
+      // Insert the card so that the deck stays in ascending order
+      int position = solver->deck_size_++;
+      for (; position > 0 && solver->values_[position - 1] > card->value_; position--)
+      {
+        solver->values_[position] = solver->values_[position - 1];
+        solver->points_[position] = solver->points_[position - 1];
+      }
+      solver->values_[position] = card->value_;
+      solver->points_[position] = getCardPoints(card);
+    }
+  }
+  for (int i = 0; i < 2; i++)
+  {
+    for (Card *card = players[i].handcards_; card != NULL; card = card->next_)
+    {
+      for (int j = 0; j < solver->deck_size_; j++)
+      {
+        if (solver->values_[j] == card->value_)
+        {
+          state->handcards_[i] |= (uint32_t)1 << j;
+        }
+      }
+    }
+  }
+  solver->positions_ = 0;
+  solver->table_hits_ = 0;
+  solver->table_mask_ = ((uint64_t)1 << SOLVER_TABLE_BITS) - 1;
+  solver->table_ = calloc(solver->table_mask_ + 1, sizeof(SolverEntry));
+  return solver->table_ != NULL ? 0 : MEMORY_ALLOCATION_ERROR;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function frees the transposition table of a solver.
+///
+/// @param solver The solver to free
+///
+/// @return void
+//
+void freeSolver(Solver *solver)
+{
+  free(solver->table_);
+  solver->table_ = NULL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function computes the value of a position with an alpha-beta search. The value is the lead in points the
+/// player to move has at the end of the game if both players play optimally from here. Positions are stored in the
+/// transposition table together with their best move, so a position that is reached again by another order of moves
+/// is not searched twice and the best move of an earlier search is tried first. Every move after the first one is
+/// only searched if boundSolverPosition cannot show that it is no better than alpha, which rules out most moves of a
+/// full deck at a fraction of their cost. Values outside of the window from alpha to beta are only bounds of the real
+/// value.
+///
+/// @param solver The solver
+/// @param state The position to compute the value of
+/// @param alpha The value the player to move is already sure to reach
+/// @param beta The value the other player is already sure to hold the player to move to
+///
+/// @return
+///      the value of the position, or a bound of it if it is outside of the window
+//
+int solvePosition(Solver *solver, const SolverState *state, int alpha, int beta)
+{
+  solver->positions_++;
+  if (isSolverGameOver(state))
+  {
+    return evaluateSolverState(state, state->turn_ % 2);
+  }
+  if (isSolverRestIndependent(state))
+  {
+    return solveIndependentRest(solver, state);
+  }
+  uint64_t key = hashSolverState(state);
+  SolverEntry *entry = &solver->table_[key & solver->table_mask_];
+  int first_move = -1;
+  if (entry->bound_ != BOUND_NONE && entry->key_ == key)
+  {
+    solver->table_hits_++;
+    if (entry->bound_ == BOUND_EXACT || (entry->bound_ == BOUND_LOWER && entry->value_ >= beta) ||
+        (entry->bound_ == BOUND_UPPER && entry->value_ <= alpha))
+    {
+      return entry->value_;
+    }
+    first_move = entry->best_move_;
+  }
+  SolverMove moves[MAX_SOLVER_MOVES];
+  int moves_count = generateSolverMoves(solver, state, moves);
+  if (first_move >= moves_count)
+  {
+    first_move = -1;
+  }
+  int player_index = state->turn_ % 2;
+  int window_alpha = alpha;
+  int best_value = -INT_MAX;
+  int best_move = 0;
+  // The best move from the table is tried before all other moves, which keep their order
+  for (int i = first_move >= 0 ? -1 : 0; i < moves_count; i++)
+  {
+    int move = i < 0 ? first_move : i;
+    if (i >= 0 && i == first_move)
+    {
+      continue;
+    }
+    SolverState child = *state;
+    applySolverMove(solver, &child, &moves[move]);
+    int value;
+    if (best_value == -INT_MAX)
+    {
+      value = -solvePosition(solver, &child, -beta, -alpha);
+    }
+    else
+    {
+      // A move whose bound is no better than alpha cannot be either, the bound still counts for the value returned
+      int bound = -boundSolverPosition(solver, &child, player_index, -alpha - 1, -alpha);
+      if (bound <= alpha)
+      {
+        best_value = bound > best_value ? bound : best_value;
+        continue;
+      }
+      // The later moves are only checked to be no better first, which is cheaper, and searched again if they are
+      value = -solvePosition(solver, &child, -alpha - 1, -alpha);
+      if (value > alpha && value < beta)
+      {
+        value = -solvePosition(solver, &child, -beta, -alpha);
+      }
+    }
+    if (value > best_value)
+    {
+      best_value = value;
+      best_move = move;
+    }
+    if (value > alpha)
+    {
+      alpha = value;
+    }
+    if (alpha >= beta)
+    {
+      break;
+    }
+  }
+  entry->key_ = key;
+  entry->value_ = best_value;
+  entry->best_move_ = (unsigned char)best_move;
+  if (best_value <= window_alpha)
+  {
+    entry->bound_ = BOUND_UPPER;
+  }
+  else if (best_value >= beta)
+  {
+    entry->bound_ = BOUND_LOWER;
+  }
+  else
+  {
+    entry->bound_ = BOUND_EXACT;
+  }
+  return best_value;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function computes a bound of the value of a position that is at least as good for one player as the real
+/// value. It searches an easier game in which the player never places his chosen cards, he keeps them until the end
+/// and then scores twice the points of his rows and of all his cards that can still extend one of them, which is
+/// more than calculatePlayerPoints can ever give him. Without the placements the game is so much smaller that the
+/// bound is cheap to search, and a bound that is no better than alpha is enough to rule out a move. The other player
+/// plays as in the real game. The bounds share the transposition table with the real values, their keys are told
+/// apart by the player.
+///
+/// @param solver The solver
+/// @param state The position to compute the bound of
+/// @param player_index The index of the player the bound is for
+/// @param alpha The value the player to move is already sure to reach
+/// @param beta The value the other player is already sure to hold the player to move to
+///
+/// @return
+///      the bound of the value of the position, or a bound of that if it is outside of the window
+//
+int boundSolverPosition(Solver *solver, const SolverState *state, int player_index, int alpha, int beta)
+{
+  solver->positions_++;
+  int to_move = state->turn_ % 2;
+  if (isSolverGameOver(state) || isSolverRestIndependent(state))
+  {
+    int points[2];
+    points[player_index] = calculateSolverPointsBound(solver, state->cardrows_[player_index],
+                                                      state->chosencards_[player_index] |
+                                                          state->handcards_[player_index]);
+    points[1 - player_index] = solveRestPlacements(solver, state, 1 - player_index);
+    return points[to_move] - points[1 - to_move];
+  }
+  if (state->turn_ == 2 + player_index)
+  {
+    // The player skips his action, his chosen cards stay with him
+    SolverState child = *state;
+    child.turn_ = (child.turn_ + 1) % 4;
+    return -boundSolverPosition(solver, &child, player_index, -beta, -alpha);
+  }
+  uint64_t key = mixSolverKey(hashSolverState(state), (uint64_t)player_index + 1);
+  SolverEntry *entry = &solver->table_[key & solver->table_mask_];
+  int first_move = -1;
+  if (entry->bound_ != BOUND_NONE && entry->key_ == key)
+  {
+    solver->table_hits_++;
+    if (entry->bound_ == BOUND_EXACT || (entry->bound_ == BOUND_LOWER && entry->value_ >= beta) ||
+        (entry->bound_ == BOUND_UPPER && entry->value_ <= alpha))
+    {
+      return entry->value_;
+    }
+    first_move = entry->best_move_;
+  }
+  SolverMove moves[MAX_SOLVER_MOVES];
+  int moves_count = generateSolverMoves(solver, state, moves);
+  if (first_move >= moves_count)
+  {
+    first_move = -1;
+  }
+  int window_alpha = alpha;
+  int best_value = -INT_MAX;
+  int best_move = 0;
+  for (int i = first_move >= 0 ? -1 : 0; i < moves_count; i++)
+  {
+    int move = i < 0 ? first_move : i;
+    if (i >= 0 && i == first_move)
+    {
+      continue;
+    }
+    SolverState child = *state;
+    applySolverMove(solver, &child, &moves[move]);
+    int value = -boundSolverPosition(solver, &child, player_index, -beta, -alpha);
+    if (value > best_value)
+    {
+      best_value = value;
+      best_move = move;
+    }
+    if (value > alpha)
+    {
+      alpha = value;
+    }
+    if (alpha >= beta)
+    {
+      break;
+    }
+  }
+  entry->key_ = key;
+  entry->value_ = best_value;
+  entry->best_move_ = (unsigned char)best_move;
+  if (best_value <= window_alpha)
+  {
+    entry->bound_ = BOUND_UPPER;
+  }
+  else if (best_value >= beta)
+  {
+    entry->bound_ = BOUND_LOWER;
+  }
+  else
+  {
+    entry->bound_ = BOUND_EXACT;
+  }
+  return best_value;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks if the game is over in a position, which is the case after an action phase in which one of
+/// the players has no hand cards left.
+///
+/// @param state The position to check
+///
+/// @return
+///      TRUE if the game is over
+///      FALSE otherwise
+//
+int isSolverGameOver(const SolverState *state)
+{
+  return state->turn_ == 0 && (state->handcards_[0] == 0 || state->handcards_[1] == 0);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks if the players cannot take cards from each other anymore. This is the case in an action phase
+/// once the hand cards are so few that they will all be kept in the next round, or once there are none left. From then
+/// on each player only places his own cards, which changes nothing for the other player.
+///
+/// @param state The position to check
+///
+/// @return
+///      TRUE if the rest of the game is independent for both players
+///      FALSE otherwise
+//
+int isSolverRestIndependent(const SolverState *state)
+{
+  if (state->turn_ < 2)
+  {
+    return FALSE;
+  }
+  int cards_counts[2] = {countBits(state->handcards_[0]), countBits(state->handcards_[1])};
+  if (cards_counts[0] == 0 || cards_counts[1] == 0)
+  {
+    // The game ends after this action phase
+    return cards_counts[0] == cards_counts[1];
+  }
+  return cards_counts[0] <= CARDS_TO_KEEP && cards_counts[1] <= CARDS_TO_KEEP;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function computes the value of a position from which the rest of the game is independent for both players.
+/// Instead of trying every placement of the second player after every placement of the first one, the best placements
+/// of each player are found on their own.
+///
+/// @param solver The solver
+/// @param state The position
+///
+/// @return
+///      the value of the position
+//
+int solveIndependentRest(Solver *solver, const SolverState *state)
+{
+  int player_index = state->turn_ % 2;
+  return solveRestPlacements(solver, state, player_index) - solveRestPlacements(solver, state, 1 - player_index);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function finds the most points a player can reach in a position from which the rest of the game is
+/// independent for both players.
+///
+/// @param solver The solver
+/// @param state The position
+/// @param player_index The index of the player
+///
+/// @return
+///      the most points the player can reach
+//
+int solveRestPlacements(Solver *solver, const SolverState *state, int player_index)
+{
+  // A player that has acted in this phase only has the hand cards of the next round left to place
+  int has_acted = player_index < state->turn_ - 2;
+  uint32_t handcards = state->handcards_[player_index];
+  return has_acted ? solvePlacements(solver, state->cardrows_[player_index], handcards, 0)
+                   : solvePlacements(solver, state->cardrows_[player_index], state->chosencards_[player_index],
+                                     handcards);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function finds the most points a player can reach by placing his chosen cards now and the given hand cards
+/// in the next round. The results are kept in the transposition table, with the rows counted like hashSolverState
+/// does, so players that reach the same rows in different ways share them.
+///
+/// @param solver The solver
+/// @param rows The rows of the player
+/// @param chosencards The cards the player places now
+/// @param handcards The cards the player places in the next round
+///
+/// @return
+///      the most points the player can reach
+//
+int solvePlacements(Solver *solver, const SolverRow *rows, uint32_t chosencards, uint32_t handcards)
+{
+  SolverState state;
+  memset(&state, 0, sizeof(state));
+  memcpy(state.cardrows_[0], rows, sizeof(state.cardrows_[0]));
+  state.chosencards_[0] = chosencards;
+  state.handcards_[0] = handcards;
+  state.turn_ = 2;
+  SolverMove moves[MAX_SOLVER_MOVES];
+  int moves_count = generateSolverMoves(solver, &state, moves);
+  if (handcards == 0)
+  {
+    // The moves are sorted by the points of the rows they leave behind, so the first one is the best
+    return moves_count > 0 ? moves[0].order_ : calculateSolverRowsPoints(rows);
+  }
+  // The key of a placement problem is told apart from the keys of game positions by its turn
+  state.turn_ = 4;
+  uint64_t key = hashSolverState(&state);
+  SolverEntry *entry = &solver->table_[key & solver->table_mask_];
+  if (entry->bound_ == BOUND_EXACT && entry->key_ == key)
+  {
+    solver->table_hits_++;
+    return entry->value_;
+  }
+  state.turn_ = 2;
+  int best_points = calculateSolverRowsPoints(rows);
+  for (int i = 0; i < moves_count; i++)
+  {
+    SolverState child = state;
+    applySolverMove(solver, &child, &moves[i]);
+    int points = solvePlacements(solver, child.cardrows_[0], handcards, 0);
+    if (points > best_points)
+    {
+      best_points = points;
+    }
+  }
+  entry->key_ = key;
+  entry->value_ = best_points;
+  entry->bound_ = BOUND_EXACT;
+  entry->best_move_ = 0;
+  return best_points;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns the lead in points of a player over the other one in a position.
+///
+/// @param state The position
+/// @param player_index The index of the player
+///
+/// @return
+///      the points of the player minus the points of the other player
+//
+int evaluateSolverState(const SolverState *state, int player_index)
+{
+  return calculateSolverRowsPoints(state->cardrows_[player_index]) -
+         calculateSolverRowsPoints(state->cardrows_[1 - player_index]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function calculates the points of the rows of a player in a solver position. The rows are scored by
+/// calculatePlayerPoints, so the solver always counts like the game does.
+///
+/// @param rows The rows of the player
+///
+/// @return
+///      the total points of the player
+//
+int calculateSolverRowsPoints(const SolverRow *rows)
+{
+  CardRow card_rows[MAX_CARD_ROWS];
+  memset(card_rows, 0, sizeof(card_rows));
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    card_rows[i].length_ = rows[i].length_;
+    card_rows[i].points_ = rows[i].points_;
+  }
+  return calculatePlayerPoints(card_rows);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function calculates more points than a player can reach with his rows and the given cards. No card can score
+/// more than twice its points, and a card that cannot extend a row now never can.
+///
+/// @param solver The solver
+/// @param rows The rows of the player
+/// @param cards The cards the player may still place
+///
+/// @return
+///      the bound of the points of the player
+//
+int calculateSolverPointsBound(const Solver *solver, const SolverRow *rows, uint32_t cards)
+{
+  int points = 0;
+  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  {
+    points += rows[i].points_;
+  }
+  for (int i = 0; i < solver->deck_size_; i++)
+  {
+    int can_extend = FALSE;
+    for (int j = 0; j < MAX_CARD_ROWS && ((cards >> i) & 1) && !can_extend; j++)
+    {
+      can_extend = canCardExtendSolverRow(&rows[j], i);
+    }
+    points += can_extend ? solver->points_[i] : 0;
+  }
+  return 2 * points;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function lists the moves of the player to move, with the most promising moves first. When choosing, a move
+/// keeps all cards at once, the order they are chosen in does not matter. When acting, a move plays all chosen cards
+/// in turn, each placed on a row it can extend or discarded. Moves are ordered by the points of the cards that can
+/// still be placed when choosing and by the points of the rows they leave behind when acting.
+///
+/// @param solver The solver
+/// @param state The position
+/// @param moves Output parameter for the moves
+///
+/// @return
+///      the number of moves
+//
+int generateSolverMoves(const Solver *solver, const SolverState *state, SolverMove *moves)
+{
+  int player_index = state->turn_ % 2;
+  const SolverRow *rows = state->cardrows_[player_index];
+  uint32_t cards_mask = state->turn_ < 2 ? state->handcards_[player_index] : state->chosencards_[player_index];
+  int cards[MAX_SOLVER_CARDS];
+  int cards_count = 0;
+  for (int i = 0; i < solver->deck_size_; i++)
+  {
+    if ((cards_mask >> i) & 1)
+    {
+      cards[cards_count++] = i;
+    }
+  }
+  int moves_count = 0;
+  if (state->turn_ < 2)
+  {
+    int worth[MAX_SOLVER_CARDS];
+    for (int i = 0; i < cards_count; i++)
+    {
+      worth[i] = 0;
+      for (int j = 0; j < MAX_CARD_ROWS && worth[i] == 0; j++)
+      {
+        worth[i] = canCardExtendSolverRow(&rows[j], cards[i]) ? solver->points_[cards[i]] : 0;
+      }
+    }
+    for (int i = 0; i < cards_count && moves_count < MAX_SOLVER_MOVES; i++)
+    {
+      if (cards_count < CARDS_TO_KEEP)
+      {
+        SolverMove move = {{cards[i], 0}, {-1, -1}, 1, worth[i]};
+        moves[moves_count++] = move;
+        continue;
+      }
+      for (int j = i + 1; j < cards_count && moves_count < MAX_SOLVER_MOVES; j++)
+      {
+        SolverMove move = {{cards[i], cards[j]}, {-1, -1}, 2, worth[i] + worth[j]};
+        moves[moves_count++] = move;
+      }
+    }
+  }
+  else
+  {
+    cards_count = cards_count < CARDS_TO_KEEP ? cards_count : CARDS_TO_KEEP;
+    // Every combination of rows is tried for the cards, -1 stands for discarding a card. The order of two cards only
+    // matters if they go to the same row, and then the other order is only needed if the first one does not fit.
+    int combinations_count = 1;
+    for (int i = 0; i < cards_count; i++)
+    {
+      combinations_count *= MAX_CARD_ROWS + 1;
+    }
+    for (int combination = 0; combination < combinations_count && moves_count < MAX_SOLVER_MOVES; combination++)
+    {
+      SolverMove move;
+      move.cards_count_ = cards_count;
+      for (int i = 0, rest = combination; i < cards_count; i++, rest /= MAX_CARD_ROWS + 1)
+      {
+        move.cards_[i] = cards[i];
+        move.rows_[i] = rest % (MAX_CARD_ROWS + 1) - 1;
+      }
+      move.order_ = placeSolverCards(solver, rows, &move);
+      if (move.order_ < 0 && cards_count == 2 && move.rows_[0] == move.rows_[1])
+      {
+        move.cards_[0] = cards[1];
+        move.cards_[1] = cards[0];
+        move.order_ = placeSolverCards(solver, rows, &move);
+      }
+      if (move.order_ >= 0)
+      {
+        moves[moves_count++] = move;
+      }
+    }
+  }
+  // Sort the moves by their order with an insertion sort, which keeps moves of the same order in place
+  for (int i = 1; i < moves_count; i++)
+  {
+    SolverMove move = moves[i];
+    int position = i;
+    for (; position > 0 && moves[position - 1].order_ < move.order_; position--)
+    {
+      moves[position] = moves[position - 1];
+    }
+    moves[position] = move;
+  }
+  return moves_count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function places the cards of an action move on a copy of the rows of the player, in the order of the move.
+///
+/// @param solver The solver
+/// @param rows The rows of the player
+/// @param move The action move
+///
+/// @return
+///      -1 if a card cannot extend the row of the move
+///      the points of the rows after the move otherwise
+//
+int placeSolverCards(const Solver *solver, const SolverRow *rows, const SolverMove *move)
+{
+  SolverRow outcome[MAX_CARD_ROWS];
+  memcpy(outcome, rows, sizeof(outcome));
+  for (int i = 0; i < move->cards_count_; i++)
+  {
+    if (move->rows_[i] >= 0)
+    {
+      if (!canCardExtendSolverRow(&outcome[move->rows_[i]], move->cards_[i]))
+      {
+        return -1;
+      }
+      addCardToSolverRow(&outcome[move->rows_[i]], move->cards_[i], solver->points_[move->cards_[i]]);
+    }
+  }
+  return calculateSolverRowsPoints(outcome);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function applies a move to a position. After player 2 has chosen, the hand cards of the players are exchanged.
+///
+/// @param solver The solver
+/// @param state The position to change
+/// @param move The move of the player to move
+///
+/// @return void
+//
+void applySolverMove(const Solver *solver, SolverState *state, const SolverMove *move)
+{
+  int player_index = state->turn_ % 2;
+  for (int i = 0; i < move->cards_count_; i++)
+  {
+    uint32_t card = (uint32_t)1 << move->cards_[i];
+    if (state->turn_ < 2)
+    {
+      state->handcards_[player_index] &= ~card;
+      state->chosencards_[player_index] |= card;
+    }
+    else
+    {
+      state->chosencards_[player_index] &= ~card;
+      if (move->rows_[i] >= 0)
+      {
+        addCardToSolverRow(&state->cardrows_[player_index][move->rows_[i]], move->cards_[i],
+                           solver->points_[move->cards_[i]]);
+      }
+    }
+  }
+  if (state->turn_ == 1)
+  {
+    uint32_t temp_handcards = state->handcards_[0];
+    state->handcards_[0] = state->handcards_[1];
+    state->handcards_[1] = temp_handcards;
+  }
+  state->turn_ = (state->turn_ + 1) % 4;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks if a card can be added to a row of the solver, like canCardExtendRow does for the game. As the
+/// deck of the solver is sorted, the numbers of the cards compare like their values.
+///
+/// @param row The row to check
+/// @param card The number of the card
+///
+/// @return
+///      TRUE if the card can extend the row
+///      FALSE otherwise
+//
+int canCardExtendSolverRow(const SolverRow *row, int card)
+{
+  return row->length_ == 0 || card < row->min_card_ || card > row->max_card_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function adds a card to a row of the solver. The card must be able to extend the row.
+///
+/// @param row The row to extend
+/// @param card The number of the card
+/// @param points The points of the card
+///
+/// @return void
+//
+void addCardToSolverRow(SolverRow *row, int card, int points)
+{
+  if (row->length_ == 0 || card < row->min_card_)
+  {
+    row->min_card_ = card;
+  }
+  if (row->length_ == 0 || card > row->max_card_)
+  {
+    row->max_card_ = card;
+  }
+  row->length_++;
+  row->points_ += points;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function computes the key of a position for the transposition table. Cards that are placed, discarded or kept
+/// by the other player can never extend a row of a player again, so the ends of a row are only counted by the cards
+/// the player can still get that are below and above the row. Positions whose rows only differ in cards that are gone
+/// play out the same, they get the same key and are solved once. Each row is packed into a single word.
+///
+/// @param state The position
+///
+/// @return
+///      the key of the position
+//
+uint64_t hashSolverState(const SolverState *state)
+{
+  uint64_t key = (uint64_t)state->turn_;
+  key = mixSolverKey(key, state->handcards_[0] | (uint64_t)state->handcards_[1] << 32);
+  key = mixSolverKey(key, state->chosencards_[0] | (uint64_t)state->chosencards_[1] << 32);
+  for (int i = 0; i < 2; i++)
+  {
+    uint32_t open_cards = state->handcards_[0] | state->handcards_[1] | state->chosencards_[i];
+    for (int j = 0; j < MAX_CARD_ROWS; j++)
+    {
+      const SolverRow *row = &state->cardrows_[i][j];
+      uint64_t below = 0;
+      uint64_t above = 0;
+      if (row->length_ > 0)
+      {
+        below = countBits(open_cards & (((uint32_t)1 << row->min_card_) - 1));
+        above = countBits(open_cards & ~(((uint32_t)2 << row->max_card_) - 1));
+      }
+      key = mixSolverKey(key, (uint64_t)(row->length_ & 0xFF) | (uint64_t)(row->points_ & 0xFFFF) << 8 |
+                                  below << 24 | above << 40);
+    }
+  }
+  return key;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function counts the bits that are set in a mask, a few bits at a time in parallel.
+///
+/// @param mask The mask
+///
+/// @return
+///      the number of set bits
+//
+int countBits(uint32_t mask)
+{
+  mask = mask - ((mask >> 1) & 0x55555555);
+  mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+  mask = (mask + (mask >> 4)) & 0x0F0F0F0F;
+  return (int)((mask * 0x01010101) >> 24);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function mixes a word into a key. For a fixed key every word gives a different result and the other way round,
+/// so positions that differ in a single word never get the same key.
+///
+/// @param key The key so far
+/// @param word The word to mix in
+///
+/// @return
+///      the new key
+//
+uint64_t mixSolverKey(uint64_t key, uint64_t word)
+{
+  key = (key ^ word) * 0x9E3779B97F4A7C15ULL;
+  return key ^ (key >> 32);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function follows one line of optimal play from a position to the end of the game. At every position the first
+/// move is taken that keeps the value of the position, which is checked with a search in a window around the value.
+/// Most of these searches are answered by the transposition table.
+///
+/// @param solver The solver that computed the value
+/// @param state The position to start from, is changed to the position at the end of the game
+/// @param value The value of the position
+/// @param line Output parameter for the moves of the line
+///
+/// @return
+///      the number of moves of the line
+//
+int findPrincipalVariation(Solver *solver, SolverState *state, int value, SolverMove *line)
+{
+  int line_length = 0;
+  int found = TRUE;
+  while (found && !isSolverGameOver(state) && line_length < MAX_SOLVER_LINE)
+  {
+    SolverMove moves[MAX_SOLVER_MOVES];
+    int moves_count = generateSolverMoves(solver, state, moves);
+    found = FALSE;
+    for (int i = 0; i < moves_count && !found; i++)
+    {
+      SolverState child = *state;
+      applySolverMove(solver, &child, &moves[i]);
+      if (-solvePosition(solver, &child, -value - 1, -value + 1) == value)
+      {
+        line[line_length++] = moves[i];
+        *state = child;
+        value = -value;
+        found = TRUE;
+      }
+    }
+  }
+  return line_length;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function prints a line of play that starts when the cards are dealt. Every move is printed as the commands
+/// the player would enter for it, grouped by rounds.
+///
+/// @param solver The solver
+/// @param line The moves of the line
+/// @param line_length The number of moves of the line
+///
+/// @return void
+//
+void printPrincipalVariation(const Solver *solver, const SolverMove *line, int line_length)
+{
+  printf("Optimal play:\n");
+  for (int i = 0; i < line_length; i++)
+  {
+    // Every move is one of the four steps of a round
+    int turn = i % 4;
+    int player_id = turn % 2 + 1;
+    if (turn == 0)
+    {
+      printf("Round %i:\n", i / 4 + 1);
+    }
+    for (int j = 0; j < line[i].cards_count_; j++)
+    {
+      int value = solver->values_[line[i].cards_[j]];
+      if (turn < 2)
+      {
+        printf("  P%i > %i\n", player_id, value);
+      }
+      else if (line[i].rows_[j] >= 0)
+      {
+        printf("  P%i > %s %i %i\n", player_id, PLACE_ACTION, line[i].rows_[j] + 1, value);
+      }
+      else
+      {
+        printf("  P%i > %s %i\n", player_id, DISCARD_ACTION, value);
+      }
+    }
   }
-  else if (player_one_points > player_two_points)
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function starts the event log of a new game. It remembers the deck the game is played with and the time the
+/// game started, the events are counted from the start.
+///
+/// @param players Both players with their starting hand cards
+///
+/// @return void
+//
+void startEventLog(const Player *players)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  event_log.start_time_ms_ = (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+  event_log.start_ns_ = getMonotonicTimeNs();
+  event_log.deck_hash_ = hashDeck(players, 2);
+  event_log.events_count_ = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function adds an event to the log of the game, together with the time since the game started. Nothing is
+/// logged if no log file was given.
+///
+/// @param type The type of the event
+/// @param index The row number of a place event or the player number of a result event, 0 otherwise
+/// @param value The card of the event or the points of a result event
+///
+/// @return void
+//
+void logEvent(EventType type, int index, int value)
+{
+  if (event_log.file_ == NULL || event_log.events_count_ >= MAX_GAME_EVENTS)
   {
-    printf("Player 1: %i points\n", player_one_points);
-    printf("Player 2: %i points\n", player_two_points);
-    printf("\n");
-    printf(PlAYER_1_WINS);
+    return;
+  }
+  GameEvent event = {type, index, value, (uint32_t)((getMonotonicTimeNs() - event_log.start_ns_) / 1000000)};
+  encodeEvent(&event, event_log.data_ + EVENT_LOG_HEADER_SIZE + event_log.events_count_ * EVENT_SIZE);
+  event_log.events_count_++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function appends the game to the log file. A finished game is followed by the points of both players, so that
+/// a replay can tell if it still ends the same way. If the file could not be written, it prints a warning.
+///
+/// @param player_one The first player
+/// @param player_two The second player
+/// @param finished TRUE if the game was played to its end, FALSE if it was quit
+///
+/// @return void
+//
+void writeEventLog(const Player *player_one, const Player *player_two, int finished)
+{
+  if (finished)
+  {
+    logEvent(EVENT_RESULT, 1, calculatePlayerPoints(player_one->cardrows_));
+    logEvent(EVENT_RESULT, 2, calculatePlayerPoints(player_two->cardrows_));
+  }
+  unsigned char *header = event_log.data_;
+  memset(header, 0, EVENT_LOG_HEADER_SIZE);
+  memcpy(header, EVENT_LOG_MAGIC, strlen(EVENT_LOG_MAGIC));
+  writeLittleEndian(header + 4, EVENT_LOG_VERSION, 2);
+  writeLittleEndian(header + 8, event_log.deck_hash_, 4);
+  writeLittleEndian(header + 12, event_log.events_count_, 4);
+  writeLittleEndian(header + 16, event_log.start_time_ms_, 8);
+  size_t length = EVENT_LOG_HEADER_SIZE + (size_t)event_log.events_count_ * EVENT_SIZE;
+  FILE *file = fopen(event_log.file_, "ab");
+  if (file == NULL)
+  {
+    printf(WARNING_LOG_NOT_WRITTEN);
+    return;
+  }
+  size_t written = fwrite(event_log.data_, 1, length, file);
+  if (fclose(file) != 0 || written != length)
+  {
+    printf(WARNING_LOG_NOT_WRITTEN);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function computes a FNV-1a hash of the hand cards the players start with, so that a log or a journal can be
+/// checked to belong to a config file without storing the whole deck with every game.
+///
+/// @param players The players with their starting hand cards
+/// @param players_count The number of players
+///
+/// @return
+///      the hash of the deck
+//
+uint32_t hashDeck(const Player *players, int players_count)
+{
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < players_count; i++)
+  {
+    for (const Card *card = players[i].handcards_; card != NULL; card = card->next_)
+    {
+      hash = (hash ^ (uint32_t)card->value_) * 16777619u;
+      hash = (hash ^ (uint32_t)card->color_) * 16777619u;
+    }
+    // Separates the hands, so that moving a card to the other player changes the hash
+    hash = (hash ^ 0xFFu) * 16777619u;
+  }
+  return hash;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function stores an event in EVENT_SIZE bytes: the type, the index, the value in two bytes and the time in four
+/// bytes.
+///
+/// @param event The event to store
+/// @param bytes Output parameter for the bytes of the event
+///
+/// @return void
+//
+void encodeEvent(const GameEvent *event, unsigned char *bytes)
+{
+  bytes[0] = (unsigned char)event->type_;
+  bytes[1] = (unsigned char)event->index_;
+  writeLittleEndian(bytes + 2, (uint64_t)event->value_, 2);
+  writeLittleEndian(bytes + 4, event->time_ms_, 4);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function reads an event from the bytes it was stored in by encodeEvent.
+///
+/// @param bytes The bytes of the event
+/// @param event Output parameter for the event
+///
+/// @return void
+//
+void decodeEvent(const unsigned char *bytes, GameEvent *event)
+{
+  event->type_ = (EventType)bytes[0];
+  event->index_ = bytes[1];
+  event->value_ = (int)readLittleEndian(bytes + 2, 2);
+  event->time_ms_ = (uint32_t)readLittleEndian(bytes + 4, 4);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function stores the lowest bytes of a value in little endian order, so that logs can be read on every machine.
+///
+/// @param bytes Output parameter for the bytes
+/// @param value The value to store
+/// @param bytes_count The number of bytes to store
+///
+/// @return void
+//
+void writeLittleEndian(unsigned char *bytes, uint64_t value, int bytes_count)
+{
+  for (int i = 0; i < bytes_count; i++)
+  {
+    bytes[i] = (unsigned char)(value >> (8 * i));
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function reads a value that was stored in little endian order.
+///
+/// @param bytes The bytes of the value
+/// @param bytes_count The number of bytes of the value
+///
+/// @return
+///      the value
+//
+uint64_t readLittleEndian(const unsigned char *bytes, int bytes_count)
+{
+  uint64_t value = 0;
+  for (int i = bytes_count - 1; i >= 0; i--)
+  {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function replays all games of an event log against the deck of the config file. Every game is executed again
+/// with the same functions as the interactive game, but without prompts and without any output. A game is invalid if
+/// it was played with another deck or one of its commands is no longer accepted, and its result has changed if it
+/// ends with other points than the ones that were logged. Counts of all outcomes are printed at the end, in quiet mode
+/// without the timing, so that the output of a replay is the same in every run.
+///
+/// @param options The parsed command line options
+///
+/// @return
+///      0 if the log was replayed
+///      2 if the config file or the log could not be opened
+///      3 if the config file or the log is invalid
+///      4 if there was a memory allocation error
+//
+int runReplay(const Options *options)
+{
+  int players_count = 0;
+  CardArena deck_arena;
+  CardArena arena;
+  if (initCardArena(&deck_arena, DECK_SIZE) != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  if (initCardArena(&arena, DECK_SIZE) != 0)
+  {
+    freeCardArena(&deck_arena);
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  Player deck_players[2];
+  int error = loadConfigFile(options->config_file_, &deck_arena, &players_count, deck_players, MIN_PLAYERS);
+  FILE *file = NULL;
+  if (error == 0)
+  {
+    file = fopen(options->replay_file_, "rb");
+    if (file == NULL)
+    {
+      printf("Error: Cannot open file: %s\n", options->replay_file_);
+      error = CANNOT_OPEN_FILE;
+    }
+  }
+  if (error != 0)
+  {
+    freeCardArena(&arena);
+    freeCardArena(&deck_arena);
+    return error;
+  }
+  setvbuf(file, NULL, _IOFBF, EVENT_LOG_READ_BUFFER_SIZE);
+  uint32_t deck_hash = hashDeck(deck_players, 2);
+  unsigned char events[MAX_GAME_EVENTS * EVENT_SIZE];
+  uint32_t game_deck_hash;
+  uint32_t events_count;
+  ReplayResult result = {0, {0}, 0, 0};
+  long long start_ns = getMonotonicTimeNs();
+  while ((error = readEventLogGame(file, events, &game_deck_hash, &events_count)) == 0)
+  {
+    ReplayStatus status = REPLAY_INVALID;
+    if (game_deck_hash == deck_hash &&
+        (error = replayGame(&arena, deck_players, events, events_count, &status)) != 0)
+    {
+      break;
+    }
+    result.games_++;
+    result.events_ += events_count;
+    result.games_by_status_[status]++;
+    if ((status == REPLAY_INVALID || status == REPLAY_CHANGED) && result.first_failed_game_ == 0)
+    {
+      result.first_failed_game_ = result.games_;
+    }
+  }
+  double seconds = (getMonotonicTimeNs() - start_ns) / 1e9;
+  fclose(file);
+  freeCardArena(&arena);
+  freeCardArena(&deck_arena);
+  if (error == INVALID_FILE)
+  {
+    printf("Error: Invalid file: %s\n", options->replay_file_);
+    return INVALID_FILE;
+  }
+  if (error == MEMORY_ALLOCATION_ERROR)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  if (!options->quiet_)
+  {
+    printf("Replayed %ld games (%lld events) in %.3f s (%.0f games/s)\n", result.games_, result.events_, seconds,
+           seconds > 0 ? result.games_ / seconds : 0.0);
+  }
+  printf("Finished: %ld, quit: %ld, unfinished: %ld\n", result.games_by_status_[REPLAY_FINISHED],
+         result.games_by_status_[REPLAY_QUIT], result.games_by_status_[REPLAY_UNFINISHED]);
+  printf("Invalid: %ld, results changed: %ld\n", result.games_by_status_[REPLAY_INVALID],
+         result.games_by_status_[REPLAY_CHANGED]);
+  if (result.first_failed_game_ > 0)
+  {
+    printf("First invalid or changed game: %ld\n", result.first_failed_game_);
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function reads the next game of an event log, its header and all of its events.
+///
+/// @param file The log file
+/// @param events Output parameter for the events, there must be room for MAX_GAME_EVENTS of them
+/// @param deck_hash Output parameter for the hash of the deck the game was played with
+/// @param events_count Output parameter for the number of events
+///
+/// @return
+///      0 if a game was read
+///      3 if the log is invalid or ends within a game
+///      5 if there are no more games
+//
+int readEventLogGame(FILE *file, unsigned char *events, uint32_t *deck_hash, uint32_t *events_count)
+{
+  unsigned char header[EVENT_LOG_HEADER_SIZE];
+  size_t bytes_read = fread(header, 1, EVENT_LOG_HEADER_SIZE, file);
+  if (bytes_read == 0 && feof(file))
+  {
+    return END_OF_INPUT;
+  }
+  if (bytes_read != EVENT_LOG_HEADER_SIZE || memcmp(header, EVENT_LOG_MAGIC, strlen(EVENT_LOG_MAGIC)) != 0 ||
+      readLittleEndian(header + 4, 2) != EVENT_LOG_VERSION)
+  {
+    return INVALID_FILE;
+  }
+  *deck_hash = (uint32_t)readLittleEndian(header + 8, 4);
+  *events_count = (uint32_t)readLittleEndian(header + 12, 4);
+  if (*events_count > MAX_GAME_EVENTS)
+  {
+    return INVALID_FILE;
+  }
+  size_t length = (size_t)*events_count * EVENT_SIZE;
+  if (fread(events, 1, length, file) != length)
+  {
+    return INVALID_FILE;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function executes the events of a game again. It follows the same rounds as the interactive game and checks
+/// every event like the command it was logged for, a game ends early at a quit event or an event that is not accepted.
+/// The events behind a finished game have to be the logged points of the players.
+///
+/// @param arena The arena for the cards of this game, it is reset before the game starts
+/// @param deck_players Both players with the sorted hand cards they start with, which are copied for this game
+/// @param events The events of the game
+/// @param events_count The number of events
+/// @param status Output parameter for the outcome of the game
+///
+/// @return
+///      0 if the game was replayed
+///      4 if there was a memory allocation error
+//
+int replayGame(CardArena *arena, const Player *deck_players, const unsigned char *events, uint32_t events_count,
+               ReplayStatus *status)
+{
+  Player players[2];
+  if (copyDeckPlayers(arena, deck_players, players) != 0)
+  {
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  uint32_t next = 0;
+  ReplayStatus result = REPLAY_CONTINUE;
+  do
+  {
+    for (int i = 0; i < 2 && result == REPLAY_CONTINUE; i++)
+    {
+      for (int kept = 0; kept < CARDS_TO_KEEP && result == REPLAY_CONTINUE; kept++)
+      {
+        result = replayNextEvent(&players[i], PHASE_CHOOSING, events, events_count, &next);
+      }
+    }
+    exchangePlayerCards(&players[0], &players[1]);
+    for (int i = 0; i < 2 && result == REPLAY_CONTINUE; i++)
+    {
+      while (players[i].chosencards_ != NULL && result == REPLAY_CONTINUE)
+      {
+        result = replayNextEvent(&players[i], PHASE_ACTION, events, events_count, &next);
+      }
+    }
+  } while (result == REPLAY_CONTINUE &&
+           (players[0].handcards_ != NULL || players[0].chosencards_ != NULL) &&
+           (players[1].handcards_ != NULL || players[1].chosencards_ != NULL));
+  if (result == REPLAY_CONTINUE)
+  {
+    int points[2] = {calculatePlayerPoints(players[0].cardrows_), calculatePlayerPoints(players[1].cardrows_)};
+    result = REPLAY_FINISHED;
+    for (; next < events_count && result != REPLAY_INVALID; next++)
+    {
+      GameEvent event;
+      decodeEvent(events + (size_t)next * EVENT_SIZE, &event);
+      if (event.type_ != EVENT_RESULT || event.index_ < 1 || event.index_ > 2)
+      {
+        result = REPLAY_INVALID;
+      }
+      else if (event.value_ != points[event.index_ - 1])
+      {
+        result = REPLAY_CHANGED;
+      }
+    }
+  }
+  *status = result;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function executes the next event of a game for a player. In the choosing phase the event has to keep one of
+/// the hand cards, in the action phase it has to place one of the chosen cards on a row it fits to or discard it.
+///
+/// @param player The player the event belongs to
+/// @param phase The phase the game is in
+/// @param events The events of the game
+/// @param events_count The number of events
+/// @param next The index of the next event, it is advanced past the event
+///
+/// @return
+///      REPLAY_CONTINUE if the event was executed
+///      REPLAY_QUIT if the game was quit
+///      REPLAY_UNFINISHED if there are no more events
+///      REPLAY_INVALID if the event is not accepted
+//
+ReplayStatus replayNextEvent(Player *player, GamePhase phase, const unsigned char *events, uint32_t events_count,
+                             uint32_t *next)
+{
+  if (*next >= events_count)
+  {
+    return REPLAY_UNFINISHED;
+  }
+  GameEvent event;
+  decodeEvent(events + (size_t)*next * EVENT_SIZE, &event);
+  (*next)++;
+  if (event.type_ == EVENT_QUIT)
+  {
+    return REPLAY_QUIT;
+  }
+  if (phase == PHASE_CHOOSING)
+  {
+    Card *card = event.type_ == EVENT_CHOOSE ? getCardFromHand(player, event.value_) : NULL;
+    if (card == NULL)
+    {
+      return REPLAY_INVALID;
+    }
+    removeCardFromHand(player, card);
+    addCardToChosen(player, card);
+    return REPLAY_CONTINUE;
+  }
+  Card *card = event.type_ == EVENT_PLACE || event.type_ == EVENT_DISCARD ? getCardFromChosen(player, event.value_)
+                                                                           : NULL;
+  if (card == NULL)
+  {
+    return REPLAY_INVALID;
+  }
+  if (event.type_ == EVENT_PLACE)
+  {
+    int row_number = event.index_ - 1;
+    if (row_number < 0 || row_number >= MAX_CARD_ROWS || !canCardExtendRow(&player->cardrows_[row_number], card))
+    {
+      return REPLAY_INVALID;
+    }
+    removeCardFromChosen(player, card);
+    addCardToRow(player, card, row_number);
   }
   else
   {
-    printf("Player 1: %i points\n", player_one_points);
-    printf("Player 2: %i points\n", player_two_points);
-    printf("\n");
-    printf(PlAYER_1_WINS);
-    printf(PlAYER_2_WINS);
+    removeCardFromChosen(player, card);
+  }
+  return REPLAY_CONTINUE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function saves the state of a game into a snapshot of SNAPSHOT_SIZE bytes. The header holds the phase, the
+/// player to move, the number of players, the number of cards in the hand cards, the chosen cards and each row of both
+/// players and the hash of the deck the game was dealt. The cards follow in the order of their lists, each with its
+/// value in two bytes and its color.
+///
+/// @param player_one The first player
+/// @param player_two The second player
+/// @param phase The phase the game is in
+/// @param current_player The index of the player to move
+/// @param players_count The number of players from the config file
+/// @param deck_hash The hash of the deck the game was dealt, as hashDeck computes it
+/// @param snapshot Output parameter for the snapshot
+///
+/// @return
+///      0 if the game was saved
+///      1 if the game does not fit into a snapshot
+//
+int saveSnapshot(const Player *player_one, const Player *player_two, GamePhase phase, int current_player,
+                 int players_count, uint32_t deck_hash, unsigned char *snapshot)
+{
+  const Player *players[] = {player_one, player_two};
+  memset(snapshot, 0, SNAPSHOT_SIZE);
+  memcpy(snapshot, SNAPSHOT_MAGIC, strlen(SNAPSHOT_MAGIC));
+  snapshot[4] = SNAPSHOT_VERSION;
+  snapshot[5] = (unsigned char)phase;
+  snapshot[6] = (unsigned char)current_player;
+  snapshot[7] = (unsigned char)players_count;
+  unsigned char *counts = snapshot + 8;
+  writeLittleEndian(snapshot + 8 + 2 * SNAPSHOT_LISTS_COUNT, deck_hash, 4);
+  unsigned char *bytes = snapshot + SNAPSHOT_HEADER_SIZE;
+  int cards_count = 0;
+  for (int i = 0; i < 2; i++)
+  {
+    const Card *lists[SNAPSHOT_LISTS_COUNT] = {players[i]->handcards_, players[i]->chosencards_};
+    for (int row = 0; row < MAX_CARD_ROWS; row++)
+    {
+      lists[2 + row] = players[i]->cardrows_[row].head_;
+    }
+    for (int list = 0; list < SNAPSHOT_LISTS_COUNT; list++)
+    {
+      for (const Card *card = lists[list]; card != NULL; card = card->next_)
+      {
+        if (cards_count == MAX_SNAPSHOT_CARDS || card->value_ < INT16_MIN || card->value_ > INT16_MAX)
+        {
+          return 1;
+        }
+        writeLittleEndian(bytes, (uint16_t)card->value_, 2);
+        bytes[2] = (unsigned char)card->color_;
+        bytes += SNAPSHOT_CARD_SIZE;
+        cards_count++;
+        counts[i * SNAPSHOT_LISTS_COUNT + list]++;
+      }
+    }
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function restores a game from a snapshot. The arena is reset and the cards of the snapshot are taken from it,
+/// so that the state of the players is the same as when the game was saved. Only games of two players are saved, and
+/// the numbers of cards in the lists must be reachable in such a game. Every list is checked while it is built, a
+/// snapshot that does not describe a valid game is rejected.
+///
+/// @param snapshot The snapshot to restore
+/// @param arena The arena for the cards of the game
+/// @param player_one Output parameter for the first player
+/// @param player_two Output parameter for the second player
+/// @param phase Output parameter for the phase the game is in
+/// @param current_player Output parameter for the index of the player to move
+/// @param players_count Output parameter for the number of players from the config file
+/// @param deck_hash Output parameter for the hash of the deck the game was dealt
+///
+/// @return
+///      0 if the game was restored
+///      3 if the snapshot is invalid
+//
+int restoreSnapshot(const unsigned char *snapshot, CardArena *arena, Player *player_one, Player *player_two,
+                    GamePhase *phase, int *current_player, int *players_count, uint32_t *deck_hash)
+{
+  if (memcmp(snapshot, SNAPSHOT_MAGIC, strlen(SNAPSHOT_MAGIC)) != 0 || snapshot[4] != SNAPSHOT_VERSION ||
+      (snapshot[5] != PHASE_CHOOSING && snapshot[5] != PHASE_ACTION) || snapshot[6] > 1 ||
+      snapshot[7] != MIN_PLAYERS || !isSnapshotReachable(snapshot + 8, (GamePhase)snapshot[5], snapshot[6]))
+  {
+    return INVALID_FILE;
+  }
+  *phase = (GamePhase)snapshot[5];
+  *current_player = snapshot[6];
+  *players_count = snapshot[7];
+  *deck_hash = (uint32_t)readLittleEndian(snapshot + 8 + 2 * SNAPSHOT_LISTS_COUNT, 4);
+  Player *players[] = {player_one, player_two};
+  resetCardArena(arena);
+  const unsigned char *counts = snapshot + 8;
+  const unsigned char *bytes = snapshot + SNAPSHOT_HEADER_SIZE;
+  const unsigned char *end = snapshot + SNAPSHOT_SIZE;
+  for (int i = 0; i < 2; i++)
+  {
+    Player *player = players[i];
+    initPlayer(player, i + 1);
+    Card **next_handcard = &player->handcards_;
+    for (int list = 0; list < SNAPSHOT_LISTS_COUNT; list++)
+    {
+      for (int j = 0; j < counts[i * SNAPSHOT_LISTS_COUNT + list]; j++, bytes += SNAPSHOT_CARD_SIZE)
+      {
+        Card *card;
+        if (bytes == end || restoreSnapshotCard(bytes, arena, &card) != 0)
+        {
+          return INVALID_FILE;
+        }
+        if (list == 0)
+        {
+          // The hand cards are saved in their sorted order, so they are appended as they come
+          *next_handcard = card;
+          next_handcard = &card->next_;
+          indexHandCard(player, card);
+        }
+        else if (list == 1)
+        {
+          addCardToChosen(player, card);
+        }
+        else if (addCardToRow(player, card, list - 2) != 0)
+        {
+          return INVALID_FILE;
+        }
+      }
+    }
   }
-  writePlayerPointsToFile(config_file, player_one_points, player_two_points);
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function writes the points of both players and the winner of the game to the config file. If the file could
-/// not be opened, it prints a warning to the console.
+/// This function checks if the numbers of cards in the lists of a snapshot can occur in a game of two players. Every
+/// round starts with hands of the same size, which shrink by CARDS_TO_KEEP cards per round. While choosing, the hand
+/// and the chosen cards of a player add up to the size of the round, the players before the player to move have kept
+/// all their cards and the players after him none. While acting, the players before the player to move have played
+/// all their chosen cards and the players after him none. The rows cannot hold more cards than were played.
 ///
-/// @param config_file The path to the config file
-/// @param player_one_points The points of the first player
-/// @param player_two_points The points of the second player
+/// @param counts The numbers of cards in the lists of both players, as saveSnapshot writes them
+/// @param phase The phase the game is in
+/// @param current_player The index of the player to move
 ///
-/// @return void
+/// @return
+///      TRUE if the lists can occur in a game
+///      FALSE otherwise
 //
-void writePlayerPointsToFile(char *config_file, int player_one_points, int player_two_points)
+int isSnapshotReachable(const unsigned char *counts, GamePhase phase, int current_player)
 {
-  FILE *file = fopen(config_file, "a"); // append mode
-  if (file == NULL)
-  {
-    printf(WARNING_FILE_NOT_WRITTEN);
-    return; // Exit code 0
-  }
-  fprintf(file, "\n");
-  if (player_one_points < player_two_points)
-  {
-    fprintf(file, "Player 2: %i points\n", player_two_points);
-    fprintf(file, "Player 1: %i points\n", player_one_points);
-    fprintf(file, "\n");
-    fprintf(file, PlAYER_2_WINS);
-  }
-  else if (player_one_points > player_two_points)
+  int round_hand_size = counts[0] + (phase == PHASE_CHOOSING ? counts[1] : CARDS_TO_KEEP);
+  if (round_hand_size < CARDS_TO_KEEP || round_hand_size > HAND_SIZE ||
+      (HAND_SIZE - round_hand_size) % CARDS_TO_KEEP != 0)
   {
-    fprintf(file, "Player 1: %i points\n", player_one_points);
-    fprintf(file, "Player 2: %i points\n", player_two_points);
-    fprintf(file, "\n");
-    fprintf(file, PlAYER_1_WINS);
+    return FALSE;
   }
-  else
+  for (int i = 0; i < 2; i++)
   {
-    fprintf(file, "Player 1: %i points\n", player_one_points);
-    fprintf(file, "Player 2: %i points\n", player_two_points);
-    fprintf(file, "\n");
-    fprintf(file, PlAYER_1_WINS);
-    fprintf(file, PlAYER_2_WINS);
+    const unsigned char *lists = counts + i * SNAPSHOT_LISTS_COUNT;
+    int chosen_count = lists[1];
+    // The player to move is the only one in the middle of the phase
+    int done_count = phase == PHASE_CHOOSING ? CARDS_TO_KEEP : 0;
+    int waiting_count = phase == PHASE_CHOOSING ? 0 : CARDS_TO_KEEP;
+    if ((i < current_player && chosen_count != done_count) || (i > current_player && chosen_count != waiting_count) ||
+        (i == current_player && (phase == PHASE_CHOOSING ? chosen_count >= CARDS_TO_KEEP : chosen_count == 0)) ||
+        chosen_count > CARDS_TO_KEEP)
+    {
+      return FALSE;
+    }
+    int hand_count = phase == PHASE_CHOOSING ? lists[0] + chosen_count : lists[0] + CARDS_TO_KEEP;
+    int played_count = HAND_SIZE - round_hand_size + (phase == PHASE_ACTION ? CARDS_TO_KEEP - chosen_count : 0);
+    int rows_count = 0;
+    for (int row = 0; row < MAX_CARD_ROWS; row++)
+    {
+      rows_count += lists[2 + row];
+    }
+    if (hand_count != round_hand_size || rows_count > played_count)
+    {
+      return FALSE;
+    }
   }
-  fclose(file);
-  file = NULL;
+  return TRUE;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function checks if the correct number of arguments is given. It should be exactly two: The program name and
-/// the config file path.
+/// This function takes a card from the arena and sets it to a card of a snapshot.
 ///
-/// @param argc The number of arguments. Same name as the main file argument.
+/// @param bytes The bytes of the card in the snapshot
+/// @param arena The arena the card is taken from
+/// @param card Output parameter for the card
 ///
 /// @return
-///      0 if the correct number of arguments is given
-///      1 if the wrong number of arguments is given
+///      0 if the card was restored
+///      3 if the card has no valid color or the arena is full
 //
-int checkMainArgumentsCount(int argc)
+int restoreSnapshotCard(const unsigned char *bytes, CardArena *arena, Card **card)
 {
-  if (argc != 2)
+  Color color = (Color)bytes[2];
+  if (color != RED && color != GREEN && color != BLUE && color != WHITE)
   {
-    printf(WRONG_ARGUMENT_COUNT_MESSAGE);
-    return 1;
+    return INVALID_FILE;
+  }
+  *card = allocateCard(arena);
+  if (*card == NULL)
+  {
+    return INVALID_FILE;
   }
+  (*card)->value_ = (int16_t)readLittleEndian(bytes, 2);
+  (*card)->color_ = color;
+  (*card)->next_ = NULL;
   return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function opens a file and returns a pointer to it. The file is open in read-only mode.
+/// This function writes a snapshot to a file, replacing the file if it exists.
 ///
-/// @param config_file The path to the config file
+/// @param snapshot_file The path to the file
+/// @param snapshot The snapshot to write
 ///
 /// @return
-///      NULL if the file could not be opened
-///      file pointer if the file could be opened
+///      0 if the snapshot was written
+///      2 if the file could not be written
 //
-FILE *openFile(char *config_file)
+int writeSnapshotFile(const char *snapshot_file, const unsigned char *snapshot)
 {
-  FILE *file = fopen(config_file, "r");
+  FILE *file = fopen(snapshot_file, "wb");
   if (file == NULL)
   {
-    printf("Error: Cannot open file: %s\n", config_file);
-    return NULL;
+    return CANNOT_OPEN_FILE;
   }
-  return file;
+  size_t written = fwrite(snapshot, 1, SNAPSHOT_SIZE, file);
+  if (fclose(file) != 0 || written != SNAPSHOT_SIZE)
+  {
+    return CANNOT_OPEN_FILE;
+  }
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// A helper function to duplicate a string. It returns a pointer to the duplicated string or NULL if there was a
-/// memory allocation error.
+/// This function reads a snapshot from a file.
 ///
-/// @param str The string to duplicate
+/// @param snapshot_file The path to the file
+/// @param snapshot Output parameter for the snapshot, it has to hold SNAPSHOT_SIZE bytes
 ///
 /// @return
-///      NULL if there was a memory allocation error
-///      a pointer to the duplicated string if there was no memory allocation error
+///      0 if the snapshot was read
+///      2 if the file could not be opened
+///      3 if the file is too short
 //
-char *duplicateString(const char *str)
+int readSnapshotFile(const char *snapshot_file, unsigned char *snapshot)
 {
-  if (str == NULL)
+  FILE *file = fopen(snapshot_file, "rb");
+  if (file == NULL)
   {
-    return NULL;
+    printf("Error: Cannot open file: %s\n", snapshot_file);
+    return CANNOT_OPEN_FILE;
   }
-  size_t len = strlen(str);
-  char *duplicate = (char *)malloc(len + 1); // +1 for the null terminator
-  if (duplicate == NULL)
+  size_t bytes_read = fread(snapshot, 1, SNAPSHOT_SIZE, file);
+  fclose(file);
+  if (bytes_read != SNAPSHOT_SIZE)
   {
-    return NULL;
+    printf("Error: Invalid file: %s\n", snapshot_file);
+    return INVALID_FILE;
   }
-  strcpy(duplicate, str);
-  return duplicate;
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// A helper function to retrieve a line from a file and avoid using getline() which is not available for this task.
-/// It returns the number of characters read (excluding null terminator) or -1 if there was a memory allocation error.
+/// This function runs the server mode. The config file is loaded once, then the server listens on a localhost TCP port
+/// or a Unix domain socket and plays a game with every client that connects. All sessions are served by a single
+/// thread with an epoll loop. A session moves forward whenever a line of input arrives and sends the same text the
+/// interactive game prints, so a client can play like on the console. The results are not written to the config file.
 ///
-/// @param lineptr A pointer to the line
-/// @param n The size of the line
-/// @param stream The file to read from
+/// @param options The parsed command line options
 ///
 /// @return
-///      -1 if there was a memory allocation error
-///      the number of characters read (excluding null terminator) if there was no memory allocation error
+///      2 if the config file could not be opened or the server could not listen on the address
+///      3 if the config file is invalid
+///      4 if there was a memory allocation error
 //
-size_t getLineFromFile(char **lineptr, size_t *n, FILE *stream)
+int runServer(const Options *options)
 {
-  if (lineptr == NULL || n == NULL || stream == NULL)
+  Server server;
+  server.sessions_count_ = 0;
+  if (initCardArena(&server.deck_arena_, DECK_SIZE) != 0)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  int config_file_error = loadConfigFile(options->config_file_, &server.deck_arena_, &server.players_count_,
+                                         server.deck_players_, MIN_PLAYERS);
+  if (config_file_error != 0)
   {
-    return (size_t)-1;
+    freeCardArena(&server.deck_arena_);
+    return config_file_error;
   }
-  if (*lineptr == NULL || *n == 0)
+  server.deck_hash_ = hashDeck(server.deck_players_, 2);
+  server.listen_fd_ = openServerSocket(options->serve_address_);
+  server.epoll_fd_ = server.listen_fd_ >= 0 ? epoll_create1(0) : -1;
+  struct epoll_event listen_event;
+  listen_event.events = EPOLLIN;
+  listen_event.data.ptr = NULL;
+  if (server.epoll_fd_ < 0 || epoll_ctl(server.epoll_fd_, EPOLL_CTL_ADD, server.listen_fd_, &listen_event) != 0)
   {
-    *n = 128; // Initial buffer size
-    *lineptr = (char *)malloc(*n);
-    if (*lineptr == NULL)
+    printf("Error: Cannot listen on: %s\n", options->serve_address_);
+    if (server.listen_fd_ >= 0)
     {
-      return (size_t)-1;
+      close(server.listen_fd_);
     }
+    if (server.epoll_fd_ >= 0)
+    {
+      close(server.epoll_fd_);
+    }
+    freeCardArena(&server.deck_arena_);
+    return CANNOT_OPEN_FILE;
+  }
+  printf("Listening on %s\n", options->serve_address_);
+  fflush(stdout);
+  struct epoll_event events[MAX_SERVER_EVENTS];
+  // With a results journal the server wakes up at least once per sync interval, so the results of a quiet server reach
+  // the disk as well. Without a sync interval every result is written and flushed at once.
+  int timeout_ms = -1;
+  if (results_journal.fd_ >= 0 && results_journal.sync_interval_ns_ > 0)
+  {
+    timeout_ms = (int)(results_journal.sync_interval_ns_ / 1000000);
   }
-  int c;
-  size_t i = 0;
-  while ((c = fgetc(stream)) != EOF && c != '\n')
+  while (TRUE)
   {
-    if (i == *n - 1)
+    int events_count = epoll_wait(server.epoll_fd_, events, MAX_SERVER_EVENTS, timeout_ms);
+    if (events_count < 0 && errno != EINTR)
     {
-      // Resize the buffer if needed
-      *n *= 2;
-      char *temp = (char *)realloc(*lineptr, *n);
-      if (temp == NULL)
+      break;
+    }
+    for (int i = 0; i < events_count; i++)
+    {
+      Session *session = events[i].data.ptr;
+      if (session == NULL)
+      {
+        acceptSessions(&server);
+        continue;
+      }
+      // Errors and hang ups are noticed by reading, which also handles the input that arrived before them
+      if ((events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) && readSession(session) != 0)
       {
-        free(*lineptr);
-        return (size_t)-1;
+        closeSession(&server, session);
+      }
+      else if (writeSession(&server, session) != 0)
+      {
+        closeSession(&server, session);
       }
-      *lineptr = temp;
     }
-    (*lineptr)[i++] = (char)c;
+    flushJournalBatch(&results_journal, &results_journal.batch_, FALSE);
   }
-  (*lineptr)[i] = '\0';
-  // Return the number of characters read (excluding null terminator)
-  return i;
-}
-
-//---------------------------------------------------------------------------------------------------------------------
-///
-/// This function reads a line from a file and returns it. It reads the file at a given line index number.
-///
-/// @param file The file to read from
-/// @param line_number The line number to read
-///
-/// @return
-///      NULL if the line could not be read
-///      a string containing the line if the line could be read
-//
-char *readLine(FILE *file, int line_number)
-{
-  char *line = NULL;
-  size_t len = 0;
-  size_t read;
-  fseek(file, 0, SEEK_SET);
-  for (int i = 0; i < line_number; i++)
+  close(server.epoll_fd_);
+  close(server.listen_fd_);
+  freeCardArena(&server.deck_arena_);
+  if (closeJournal(&results_journal) != 0)
   {
-    read = getLineFromFile(&line, &len, file);
-
-    // Check for end of file
-    if (read == (size_t)-1) {
-      free(line);
-      return NULL; // Line number out of bounds
-    }
+    printf(WARNING_JOURNAL_NOT_WRITTEN);
   }
-  char *result = duplicateString(line);
-  free(line);
-  line = NULL;
-  return result;
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function checks if the config file is valid. It checks if the magic number is correct and if the number of
-/// players is correct.
+/// This function opens the listening socket of the server. An address that is a number is a TCP port on localhost,
+/// any other address is the path of a Unix domain socket. A socket that was left at the path by an earlier server is
+/// replaced, other files are not.
 ///
-/// @param config_file The path to the config file
+/// @param address The port or the socket path
 ///
 /// @return
-///      0 if the config file is valid
-///      2 if the config file could not be opened
-///      3 if the config file is invalid
+///      -1 if the socket could not be opened
+///      the file descriptor of the non-blocking listening socket otherwise
 //
-int checkConfigFile(char *config_file)
+int openServerSocket(const char *address)
 {
-  FILE *file = openFile(config_file);
-  if (file == NULL)
+  char *endptr;
+  long port = strtol(address, &endptr, 10);
+  int fd;
+  int bind_result;
+  if (*address != '\0' && *endptr == '\0')
   {
-    return CANNOT_OPEN_FILE;
+    if (port < 1 || port > MAX_SERVER_PORT || (fd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+    {
+      return -1;
+    }
+    int reuse = TRUE;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in inet_address;
+    memset(&inet_address, 0, sizeof(inet_address));
+    inet_address.sin_family = AF_INET;
+    inet_address.sin_port = htons((uint16_t)port);
+    inet_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind_result = bind(fd, (struct sockaddr *)&inet_address, sizeof(inet_address));
   }
-  char *magic_number = "ESP";
-  char *line = NULL;
-  size_t len = 0;
-  size_t read;
-  read = getLineFromFile(&line, &len, file);
-  if (read == (size_t)-1)
+  else
   {
-    printf("Error: Invalid file: %s\n", config_file);
-    fclose(file);
-    free(line);
-    return INVALID_FILE;
+    struct sockaddr_un unix_address;
+    memset(&unix_address, 0, sizeof(unix_address));
+    unix_address.sun_family = AF_UNIX;
+    if (strlen(address) >= sizeof(unix_address.sun_path) || (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+      return -1;
+    }
+    strcpy(unix_address.sun_path, address);
+    struct stat file_status;
+    if (stat(address, &file_status) == 0 && S_ISSOCK(file_status.st_mode))
+    {
+      unlink(address);
+    }
+    bind_result = bind(fd, (struct sockaddr *)&unix_address, sizeof(unix_address));
   }
-  if (strcmp(line, magic_number) != 0)
+  if (bind_result != 0 || listen(fd, SERVER_BACKLOG) != 0 || setNonBlocking(fd) != 0)
   {
-    printf("Error: Invalid file: %s\n", config_file);
-    free(line);
-    fclose(file);
-    return INVALID_FILE;
+    close(fd);
+    return -1;
   }
-  free(line);
-  fclose(file);
-  return 0;
+  return fd;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function gets the number of players from the config file. Its not really necessary, as we only play with two
-/// players, but it might be useful to extend the game to more players in the future.
+/// This function switches a file descriptor to non-blocking mode.
 ///
-/// @param config_file The path to the config file
+/// @param fd The file descriptor
 ///
 /// @return
-///      -1 if the file could not be opened
-///      the number of players if the file could be opened
+///      0 if the mode was set
+///      -1 otherwise
 //
-int getPlayersCount(char *config_file)
+int setNonBlocking(int fd)
 {
-  FILE *file = openFile(config_file);
-  if (file == NULL)
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
   {
     return -1;
   }
-  // The number of players is defined in the second line of the file
-  char *line = readLine(file, 2);
-  int players_count = stringToInt(line);
-  free(line);
-  fclose(file);
-  return players_count;
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function prints a welcome message to the console.
+/// This function accepts all pending connections and starts a session for each of them. A connection that cannot get
+/// a session is closed right away. The first output of a session is sent at once.
 ///
-/// @param players_count The number of players
+/// @param server The server
 ///
 /// @return void
 //
-void printWelcomeMessage(int players_count)
+void acceptSessions(Server *server)
 {
-  printf("Welcome to SyntaxSakura (%i players are playing)!\n", players_count);
-  printf("\n");
+  while (TRUE)
+  {
+    int fd = accept(server->listen_fd_, NULL, NULL);
+    if (fd < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return;
+    }
+    Session *session = setNonBlocking(fd) == 0 ? startSession(server, fd) : NULL;
+    if (session == NULL)
+    {
+      close(fd);
+      continue;
+    }
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = session;
+    session->events_ = EPOLLIN;
+    if (epoll_ctl(server->epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+      session->events_ = 0;
+      closeSession(server, session);
+      continue;
+    }
+    server->sessions_count_++;
+    if (writeSession(server, session) != 0)
+    {
+      closeSession(server, session);
+    }
+  }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function parses a string and returns the corresponding color for the creation of a Card.
+/// This function starts a session for a new connection. Both players get the hand cards of the deck of the server and
+/// the welcome message and the first prompt are rendered.
 ///
-/// @param color The string to parse
+/// @param server The server
+/// @param fd The file descriptor of the connection
 ///
 /// @return
-///      RED if the string is "r"
-///      GREEN if the string is "g"
-///      BLUE if the string is "b"
-///      WHITE if the string is "w"
-///      '\0' if the string is invalid
+///      NULL if there was a memory allocation error
+///      the new session otherwise
 //
-Color parseColor(char *color)
+Session *startSession(const Server *server, int fd)
 {
-  if (strcmp(color, "r") == 0)
+  Session *session = malloc(sizeof(Session));
+  if (session == NULL)
   {
-    return RED;
-  }
-  else if (strcmp(color, "g") == 0)
-  {
-    return GREEN;
-  }
-  else if (strcmp(color, "b") == 0)
-  {
-    return BLUE;
+    return NULL;
   }
-  else if (strcmp(color, "w") == 0)
+  if (initCardArena(&session->arena_, DECK_SIZE) != 0)
   {
-    return WHITE;
+    free(session);
+    return NULL;
   }
-  else
+  if (copyDeckPlayers(&session->arena_, server->deck_players_, session->players_) != 0)
   {
-    printf("Error: Invalid color: %s\n", color);
-    return '\0';
+    freeCardArena(&session->arena_);
+    free(session);
+    return NULL;
   }
+  session->fd_ = fd;
+  session->phase_ = PHASE_CHOOSING;
+  session->current_player_ = 0;
+  session->skip_prompt_ = FALSE;
+  session->closing_ = FALSE;
+  session->events_ = 0;
+  session->random_state_ = (uint64_t)getMonotonicTimeNs() ^ (uint64_t)fd;
+  session->input_length_ = 0;
+  session->output_.data_ = NULL;
+  session->output_.length_ = 0;
+  session->output_.capacity_ = 0;
+  session->output_sent_ = 0;
+  session->deck_hash_ = server->deck_hash_;
+  session->start_ns_ = getMonotonicTimeNs();
+  appendFormatted(&session->output_, WELCOME_MESSAGE, server->players_count_);
+  appendString(&session->output_, "\n" CARD_CHOOSING_PHASE_TITLE "\n");
+  beginSessionTurn(session);
+  return session;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function creates a card from a line in the config file. It parses the value and the color from the string
-/// and returns a Card from it. The Card is malloced and returned.
+/// This function ends a session. The connection is closed and all memory of the session is freed.
 ///
-/// @param config_file_line The line from the config file
+/// @param server The server
+/// @param session The session to end
 ///
-/// @return
-///      NULL if the card could not be created
-///      a pointer to the card if the card could be created
+/// @return void
 //
-Card *createCard(char *config_file_line)
+void closeSession(Server *server, Session *session)
 {
-  Card *card = malloc(sizeof(Card));
-  if (card == NULL)
+  if (session->events_ != 0)
   {
-    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
-    return NULL;
+    epoll_ctl(server->epoll_fd_, EPOLL_CTL_DEL, session->fd_, NULL);
+    server->sessions_count_--;
   }
-  int value = stringToInt(strtok(config_file_line, "_"));
-  char *color = strtok(NULL, "_");
-  color[strcspn(color, "\n")] = 0;
-  card->color_ = parseColor(color);
-  card->value_ = value;
-  card->next_ = NULL;
-  return card;
+  close(session->fd_);
+  freeCardArena(&session->arena_);
+  freeOutputBuffer(&session->output_);
+  free(session);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function assigns the cards from the config file to the players. It returns 0 if the cards could be assigned
-/// successfully and an error code otherwise. It starts with the first line of cards in the config file and assigns
-/// every second card to the first player and every other second card to the second player.
+/// This function reads the input that has arrived for a session and handles every complete line. The end of the input
+/// ends the game like quit does, a last line without a newline is handled before. Reading pauses while a lot of output
+/// is waiting, so a client that does not read cannot make the session grow without limits.
 ///
-/// @param player_one_handcards The hand cards of the first player
-/// @param player_two_handcards The hand cards of the second player
-/// @param config_file The path to the config file
+/// @param session The session to read for
 ///
 /// @return
-///      0 if the cards could be assigned successfully
-///      2 if the file could not be opened
-///      4 if there was a memory allocation error
+///      0 if the session goes on, possibly to send its last output
+///      1 if the connection failed or a line is longer than the input buffer
 //
-int assignCardsToPlayers(Card **player_one_handcards, Card **player_two_handcards, char *config_file)
+int readSession(Session *session)
 {
-  FILE *file = openFile(config_file);
-  if (file == NULL)
-  {
-    return CANNOT_OPEN_FILE;
-  }
-  for (int i = CONFIG_CARDS_LINE_START; i < CONFIG_CARDS_LINE_END; i++)
+  while (!session->closing_ && session->output_.length_ - session->output_sent_ < MAX_SESSION_OUTPUT)
   {
-    char *line = readLine(file, i);
-    Card *temp_card = createCard(line);
-    free(line);
-    line = NULL;
-    if (temp_card == NULL)
+    if (session->input_length_ == SESSION_INPUT_SIZE)
     {
-      fclose(file);
-      return MEMORY_ALLOCATION_ERROR;
+      return 1;
     }
-    if (i % 2 != 0)
+    ssize_t bytes_read = recv(session->fd_, session->input_ + session->input_length_,
+                              SESSION_INPUT_SIZE - session->input_length_, 0);
+    if (bytes_read < 0)
     {
-      // Assign card to player one
-      addCardToHand(player_one_handcards, temp_card);
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : 1;
     }
-    else
+    if (bytes_read == 0)
+    {
+      if (session->input_length_ > 0)
+      {
+        // The input buffer has one byte more than it is filled with, for the terminator of a last line
+        session->input_[session->input_length_] = '\0';
+        handleSessionLine(session, session->input_);
+      }
+      session->closing_ = TRUE;
+      return 0;
+    }
+    size_t start = 0;
+    size_t length = session->input_length_ + bytes_read;
+    char *newline;
+    while (!session->closing_ && (newline = memchr(session->input_ + start, '\n', length - start)) != NULL)
     {
-      addCardToHand(player_two_handcards, temp_card);
+      *newline = '\0';
+      handleSessionLine(session, session->input_ + start);
+      start = newline - session->input_ + 1;
     }
+    memmove(session->input_, session->input_ + start, length - start);
+    session->input_length_ = length - start;
   }
-  fclose(file);
   return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function exchanges the hand cards of the two players.
+/// This function sends as much of the output of a session as the connection takes and updates the events the session
+/// waits for. A session waits for input unless it is closing or has too much output waiting, and for the connection to
+/// become writable while output is left.
 ///
-/// @param player_one_handcards The hand cards of the first player
-/// @param player_two_handcards The hand cards of the second player
+/// @param server The server
+/// @param session The session to write for
 ///
 /// @return
-///      0 if the cards could be exchanged successfully
+///      0 if the session goes on
+///      1 if the connection failed or a closing session has sent all of its output
 //
-int exchangePlayerCards(Card **player_one_handcards, Card **player_two_handcards)
+int writeSession(Server *server, Session *session)
 {
-  Card *temp_hand_cards = *player_one_handcards;
-  *player_one_handcards = *player_two_handcards;
-  *player_two_handcards = temp_hand_cards;
+  OutputBuffer *output = &session->output_;
+  while (session->output_sent_ < output->length_)
+  {
+    ssize_t bytes_sent = send(session->fd_, output->data_ + session->output_sent_,
+                              output->length_ - session->output_sent_, MSG_NOSIGNAL);
+    if (bytes_sent < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        break;
+      }
+      return 1;
+    }
+    session->output_sent_ += bytes_sent;
+  }
+  if (session->output_sent_ == output->length_)
+  {
+    output->length_ = 0;
+    session->output_sent_ = 0;
+    if (session->closing_)
+    {
+      return 1;
+    }
+  }
+  uint32_t events = output->length_ > 0 ? EPOLLOUT : 0;
+  if (!session->closing_ && output->length_ - session->output_sent_ < MAX_SESSION_OUTPUT)
+  {
+    events |= EPOLLIN;
+  }
+  if (events != session->events_)
+  {
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = session;
+    if (epoll_ctl(server->epoll_fd_, EPOLL_CTL_MOD, session->fd_, &event) != 0)
+    {
+      return 1;
+    }
+    session->events_ = events;
+  }
   return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function prints the card choosing phase text to the console.
+/// This function handles a line of input of a session in the phase the game is in.
+///
+/// @param session The session
+/// @param line The line without its newline
 ///
 /// @return void
 //
-void printCardChoosingPhase()
+void handleSessionLine(Session *session, const char *line)
 {
-  printf("-------------------\n");
-  printf("CARD CHOOSING PHASE\n");
-  printf("-------------------\n");
-  printf("\n");
+  if (session->phase_ == PHASE_CHOOSING)
+  {
+    handleSessionChoice(session, line);
+  }
+  else
+  {
+    handleSessionAction(session, line);
+  }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function prints the action phase text to the console.
+/// This function handles a line of the card choosing phase of a session like chooseCardToKeep does for the console.
+///
+/// @param session The session
+/// @param line The line without its newline
 ///
 /// @return void
 //
-void printActionPhase()
+void handleSessionChoice(Session *session, const char *line)
 {
-  printf("------------\n");
-  printf("ACTION PHASE\n");
-  printf("------------\n");
-  printf("\n");
+  Player *player = &session->players_[session->current_player_];
+  Command command;
+  parseChoosingCommand(line, &command);
+  session->skip_prompt_ = TRUE;
+  if ((command.type_ == COMMAND_QUIT || command.type_ == COMMAND_HINT) && command.arguments_count_ > 0)
+  {
+    appendString(&session->output_, WRONG_PARAMETERS_COUNT);
+  }
+  else if (command.type_ == COMMAND_QUIT)
+  {
+    session->closing_ = TRUE;
+    return;
+  }
+  else if (command.type_ == COMMAND_HINT)
+  {
+    hintSession(session);
+  }
+  else
+  {
+    int card_number = command.arguments_[0];
+    Card *chosen_card = card_number >= 1 && card_number <= 120 ? getCardFromHand(player, card_number) : NULL;
+    if (chosen_card == NULL)
+    {
+      appendString(&session->output_, WRONG_HANDCARDS_NUMBER);
+    }
+    else
+    {
+      removeCardFromHand(player, chosen_card);
+      addCardToChosen(player, chosen_card);
+      session->skip_prompt_ = FALSE;
+      if (countCards(player->chosencards_) >= CARDS_TO_KEEP || player->handcards_ == NULL)
+      {
+        appendString(&session->output_, "\n");
+        endSessionTurn(session);
+        return;
+      }
+    }
+  }
+  promptSession(session);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function performs the card choosing phase. It starts with the first player and lets him choose two cards from
-/// his hand cards and add them to his chosen cards. Then it does the same for the second player. It returns 0 if the
-/// card choosing phase could be performed successfully and 1 otherwise.
+/// This function handles a line of the action phase of a session like actionChoosingLoop does for the console.
 ///
-/// @param player_one_handcards The hand cards of the first player
-/// @param player_one_chosencards The chosen cards of the first player
-/// @param player_one_cardrows The card rows of the first player
-/// @param player_two_handcards The hand cards of the second player
-/// @param player_two_chosencards The chosen cards of the second player
-/// @param player_two_cardrows The card rows of the second player
+/// @param session The session
+/// @param line The line without its newline
 ///
-/// @return
-///      0 if the card choosing phase could be performed successfully
-///      1 if the card choosing phase could not be performed successfully
+/// @return void
 //
-int cardChoosingPhase(Card **player_one_handcards, Card **player_one_chosencards, Card ***player_one_cardrows,
-                      Card **player_two_handcards, Card **player_two_chosencards, Card ***player_two_cardrows)
+void handleSessionAction(Session *session, const char *line)
 {
-  printPlayer(1, player_one_handcards, player_one_chosencards, player_one_cardrows);
-  printf(PROMPT_CHOOSE_FIRST_CARD);
-  if (chooseCardToKeep(1, player_one_handcards, player_one_chosencards) == 1)
+  Player *player = &session->players_[session->current_player_];
+  Command command;
+  parseActionCommand(line, &command);
+  const char *error_message = NULL;
+  session->skip_prompt_ = TRUE;
+  if (command.type_ == COMMAND_PLACE || command.type_ == COMMAND_DISCARD)
+  {
+    error_message = command.type_ == COMMAND_PLACE ? applyPlaceCommand(&command, player)
+                                                   : applyDiscardCommand(&command, player);
+  }
+  else if ((command.type_ == COMMAND_QUIT || command.type_ == COMMAND_HELP || command.type_ == COMMAND_HINT) &&
+           command.arguments_count_ > 0)
+  {
+    error_message = WRONG_PARAMETERS_COUNT;
+  }
+  else if (command.type_ == COMMAND_QUIT)
   {
-    return 1;
+    session->closing_ = TRUE;
+    return;
   }
-  printf(PROMPT_CHOOSE_SECOND_CARD);
-  if (chooseCardToKeep(1, player_one_handcards, player_one_chosencards) == 1)
+  else if (command.type_ == COMMAND_HINT)
   {
-    return 1;
+    hintSession(session);
+    promptSession(session);
+    return;
   }
-  printf("\n");
-  printPlayer(2, player_two_handcards, player_two_chosencards, player_two_cardrows);
-  printf(PROMPT_CHOOSE_FIRST_CARD);
-  if (chooseCardToKeep(2, player_two_handcards, player_two_chosencards) == 1)
+  else if (command.type_ == COMMAND_HELP)
   {
-    return 1;
+    appendString(&session->output_, HELP_MESSAGE);
+  }
+  else
+  {
+    error_message = INVALID_COMMAND;
   }
-  printf(PROMPT_CHOOSE_SECOND_CARD);
-  if (chooseCardToKeep(2, player_two_handcards, player_two_chosencards) == 1)
+  if (error_message != NULL)
   {
-    return 1;
+    appendString(&session->output_, error_message);
+    promptSession(session);
+    return;
   }
-  printf("\n");
-  printf(CHOOSING_PHASE_IS_OVER);
-  printf("\n");
-  return 0;
+  appendString(&session->output_, "\n");
+  renderPlayer(&session->output_, player);
+  session->skip_prompt_ = FALSE;
+  if (player->chosencards_ == NULL)
+  {
+    appendString(&session->output_, "\n");
+    endSessionTurn(session);
+    return;
+  }
+  promptSession(session);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function prints the details of a player to the console. It prints the hand cards, the chosen cards and the card
-/// rows of the player.
+/// This function answers the hint command of a session. The search of the interactive game would stop all other
+/// sessions while it runs, so the hint comes from the greedy strategy instead.
 ///
-/// @param player_id The number of the player
-/// @param player_handcards The hand cards of the player
-/// @param player_chosencards The chosen cards of the player
-/// @param player_cardrows The card rows of the player
+/// @param session The session
 ///
 /// @return void
 //
-void printPlayer(int player_id, Card **player_handcards, Card **player_chosencards, Card ***player_cardrows)
+void hintSession(Session *session)
 {
-  printf("Player %i:\n", player_id);
-  printPlayerHandCards(player_handcards);
-  printPlayerChosenCards(player_chosencards);
-  printPlayerCardRows(player_cardrows);
-  printf("\n");
+  const Player *player = &session->players_[session->current_player_];
+  const Player *opponent = &session->players_[1 - session->current_player_];
+  if (session->phase_ == PHASE_CHOOSING)
+  {
+    const Card *card = chooseGreedyCard(player, opponent, &session->random_state_);
+    appendFormatted(&session->output_, "Hint: keep %i\n", card->value_);
+    return;
+  }
+  int row_number = -1;
+  const Card *card = chooseGreedyAction(player, opponent, &row_number, &session->random_state_);
+  if (row_number >= 0)
+  {
+    appendFormatted(&session->output_, "Hint: %s %i %i\n", PLACE_ACTION, row_number + 1, card->value_);
+  }
+  else
+  {
+    appendFormatted(&session->output_, "Hint: %s %i\n", DISCARD_ACTION, card->value_);
+  }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// A helper function to print the card on each row of a player. It will print nothing, if the row is empty.
+/// This function starts the turn of the current player of a session by rendering the status of the player and the
+/// prompt.
 ///
-/// @param player_cardrows The card rows of the player
+/// @param session The session
 ///
 /// @return void
 //
-void printPlayerCardRows(Card **const *player_cardrows)
+void beginSessionTurn(Session *session)
 {
-  Card *head = NULL;
-  if (player_cardrows != NULL && *player_cardrows != NULL)
-  {
-    for (int i = 0; i < MAX_CARD_ROWS; i++)
-    {
-      if ((*player_cardrows)[i] != NULL && (*player_cardrows)[i]->color_ != '\0')
-      {
-        printf("  row_%i: ", i+1);
-        head = (*player_cardrows)[i];
-        while (head != NULL)
-        {
-          if (head->next_ != NULL)
-          {
-            printf("%i_%c ", head->value_, head->color_);
-          }
-          else
-          {
-            printf("%i_%c\n", head->value_, head->color_);
-          }
-          head = head->next_;
-        }
-      }
-    }
-  }
+  renderPlayer(&session->output_, &session->players_[session->current_player_]);
+  session->skip_prompt_ = FALSE;
+  promptSession(session);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// A helper function to print all the chosen cards of a player. It will print just the label "chosen cards:" if the
-/// player has no chosen cards.
+/// This function ends the turn of the current player of a session. The second player of the phase goes next, after
+/// both players the phase is over: the hand cards are passed on after the card choosing phase, and after the action
+/// phase the next round starts or the points are rendered and the session closes.
 ///
-/// @param player_chosencards The chosen cards of the player
+/// @param session The session
 ///
 /// @return void
 //
-void printPlayerChosenCards(Card *const *player_chosencards)
+void endSessionTurn(Session *session)
 {
-  printf("  chosen cards:");
-  Card *head = *player_chosencards;
-  if (head != NULL && head->color_ != '\0')
+  Player *players = session->players_;
+  OutputBuffer *output = &session->output_;
+  if (session->current_player_ == 0)
   {
-    printf(" ");
+    session->current_player_ = 1;
+    beginSessionTurn(session);
+    return;
   }
-  else
+  session->current_player_ = 0;
+  if (session->phase_ == PHASE_CHOOSING)
   {
-    printf("\n");
+    appendString(output, CHOOSING_PHASE_IS_OVER "\n" ACTION_PHASE_TITLE "\n");
+    exchangePlayerCards(&players[0], &players[1]);
+    session->phase_ = PHASE_ACTION;
+    beginSessionTurn(session);
+    return;
   }
-  while (head != NULL && head->color_ != '\0')
+  appendString(output, ACTION_PHASE_IS_OVER "\n");
+  if (isGameOver(players, 2))
   {
-    if (head->next_ != NULL)
-    {
-      printf("%i_%c ", head->value_, head->color_);
-    }
-    else
-    {
-      printf("%i_%c\n", head->value_, head->color_);
-    }
-    head = head->next_;
+    int points[] = {calculatePlayerPoints(players[0].cardrows_), calculatePlayerPoints(players[1].cardrows_)};
+    appendString(output, "\n");
+    renderPlayerPoints(output, points, 2);
+    JournalRecord record;
+    fillJournalRecord(&record, session->deck_hash_, points, 2, session->start_ns_);
+    addJournalRecord(&results_journal, &results_journal.batch_, &record);
+    session->closing_ = TRUE;
+    return;
   }
+  session->phase_ = PHASE_CHOOSING;
+  appendString(output, CARD_CHOOSING_PHASE_TITLE "\n");
+  beginSessionTurn(session);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// A helper function to print all the hand cards of a player. It will print just the label "hand cards:" if the player
-/// has no hand cards.
+/// This function renders the prompt for the current player of a session. The request to choose a card or an action
+/// is left out after a command that was not accepted, like on the console.
 ///
-/// @param player_handcards The hand cards of the player
+/// @param session The session
 ///
 /// @return void
 //
-void printPlayerHandCards(Card *const *player_handcards)
+void promptSession(Session *session)
 {
-  printf("  hand cards:");
-  Card *head = *player_handcards;
-  if (head != NULL && head->color_ != '\0')
-  {
-    printf(" ");
-  }
-  else
+  const Player *player = &session->players_[session->current_player_];
+  if (!session->skip_prompt_)
   {
-    printf("\n");
-  }
-  while (head != NULL && head->color_ != '\0')
-  {
-    if (head->next_ != NULL)
+    if (session->phase_ == PHASE_ACTION)
     {
-      printf("%i_%c ", head->value_, head->color_);
+      appendString(&session->output_, PROMPT_PLAYER_ACTION);
     }
     else
     {
-      printf("%i_%c\n", head->value_, head->color_);
+      appendString(&session->output_, player->chosencards_ == NULL ? PROMPT_CHOOSE_FIRST_CARD
+                                                                    : PROMPT_CHOOSE_SECOND_CARD);
     }
-    head = head->next_;
   }
+  appendFormatted(&session->output_, "P%i > ", player->id_);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Retrieves a card from the hand cards of a player by searching for its value. It returns a pointer to the card.
+/// This function opens the results journal for appending. A new journal starts with a header that names the format
+/// and the size of the records, an existing journal is only appended to if its header matches. A record that was cut
+/// off at the end of an existing journal by a crash is removed, so the records that follow stay aligned.
 ///
-/// @param player_handcards The hand cards of the player
-/// @param card_number The value of the card to retrieve
+/// @param journal The journal to open
+/// @param journal_file The path to the journal file
+/// @param sync_interval_ms The time in milliseconds that records may wait in memory or in the page cache
 ///
 /// @return
-///      NULL if the card could not be found
-///      a pointer to the card if the card could be found
+///      0 if the journal was opened
+///      2 if the journal file could not be opened
+///      3 if the journal file is not a results journal
 //
-Card *getCardFromHand(Card *player_handcards, int card_number)
+int openJournal(Journal *journal, const char *journal_file, long sync_interval_ms)
 {
-  Card *head = player_handcards;
-  while (head != NULL)
+  int fd = open(journal_file, O_RDWR | O_CREAT | O_APPEND, 0644);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0)
   {
-    if (head->value_ == card_number)
+    printf("Error: Cannot open file: %s\n", journal_file);
+    if (fd >= 0)
     {
-      return head;
+      close(fd);
     }
-    head = head->next_;
+    return CANNOT_OPEN_FILE;
   }
-  return NULL;
+  unsigned char header[JOURNAL_HEADER_SIZE];
+  if (file_stat.st_size == 0)
+  {
+    memcpy(header, JOURNAL_MAGIC, strlen(JOURNAL_MAGIC));
+    writeLittleEndian(header + 4, JOURNAL_VERSION, 2);
+    writeLittleEndian(header + 6, JOURNAL_RECORD_SIZE, 2);
+    if (write(fd, header, JOURNAL_HEADER_SIZE) != JOURNAL_HEADER_SIZE)
+    {
+      printf("Error: Cannot open file: %s\n", journal_file);
+      close(fd);
+      return CANNOT_OPEN_FILE;
+    }
+  }
+  else if (pread(fd, header, JOURNAL_HEADER_SIZE, 0) != JOURNAL_HEADER_SIZE ||
+           memcmp(header, JOURNAL_MAGIC, strlen(JOURNAL_MAGIC)) != 0 ||
+           readLittleEndian(header + 4, 2) != JOURNAL_VERSION ||
+           readLittleEndian(header + 6, 2) != JOURNAL_RECORD_SIZE)
+  {
+    printf("Error: Invalid file: %s\n", journal_file);
+    close(fd);
+    return INVALID_FILE;
+  }
+  else
+  {
+    off_t torn_length = (file_stat.st_size - JOURNAL_HEADER_SIZE) % JOURNAL_RECORD_SIZE;
+    if (torn_length != 0 && ftruncate(fd, file_stat.st_size - torn_length) != 0)
+    {
+      printf("Error: Cannot open file: %s\n", journal_file);
+      close(fd);
+      return CANNOT_OPEN_FILE;
+    }
+  }
+  journal->fd_ = fd;
+  journal->sync_interval_ns_ = (long long)sync_interval_ms * 1000000;
+  journal->last_sync_ns_ = getMonotonicTimeNs();
+  journal->unsynced_ = FALSE;
+  journal->error_ = 0;
+  journal->batch_.records_count_ = 0;
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Retrieves a card from the chosen cards of a player by searching for its value. It returns a pointer to the card.
+/// This function writes the records that are still in the batch of the journal, flushes the journal to the disk and
+/// closes it. The batches of other threads have to be flushed before.
 ///
-/// @param player_chosencards The chosen cards of the player
-/// @param card_number The value of the card to retrieve
+/// @param journal The journal to close
 ///
 /// @return
-///      NULL if the card could not be found
-///      a pointer to the card if the card could be found
+///      0 if every record was written
+///      1 if a record could not be written
 //
-Card *getCardFromChosen(Card *player_chosencards, int card_number)
+int closeJournal(Journal *journal)
 {
-  Card *head = player_chosencards;
-  while (head != NULL)
+  if (journal->fd_ < 0)
   {
-    if (head->value_ == card_number)
-    {
-      return head;
-    }
-    head = head->next_;
+    return 0;
   }
-  return NULL;
+  flushJournalBatch(journal, &journal->batch_, TRUE);
+  if (journal->unsynced_ && fsync(journal->fd_) != 0)
+  {
+    journal->error_ = 1;
+  }
+  if (close(journal->fd_) != 0)
+  {
+    journal->error_ = 1;
+  }
+  journal->fd_ = -1;
+  return journal->error_;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function simulates the choosing phase, where each player chooses two cards to keep from his hand cards. It
-/// returns 0 if the action choosing phase could be performed successfully and 1 otherwise.
+/// This function fills in the record of a finished game. The players are ranked in a single pass, so a record costs
+/// linear time in the number of players.
 ///
-/// @param player_id The number of the player
-/// @param player_handcards The hand cards of the player
-/// @param player_chosencards The chosen cards of the player
-/// @param player_cardrows The card rows of the player
+/// @param record The record to fill in
+/// @param deck_hash The hash of the deck the game was played with
+/// @param points The points of the players, indexed like the players
+/// @param players_count The number of players
+/// @param start_ns The monotonic time the game started at
 ///
-/// @return
-///      0 if the action choosing phase could be performed successfully
-///      1 if the action choosing phase could not be performed successfully
+/// @return void
 //
-int chooseCardToKeep(int player_id, Card **player_handcards, Card **player_chosencards)
+void fillJournalRecord(JournalRecord *record, uint32_t deck_hash, const int *points, int players_count,
+                       long long start_ns)
 {
-  Card *chosen_card;
-  do
+  int first_points = INT_MIN;
+  int second_points = INT_MIN;
+  uint64_t winners = 0;
+  for (int i = 0; i < players_count; i++)
   {
-    chosen_card = NULL;
-    int card_number;
-    printf("P%i > ", player_id);
-    char *input = readInput();
-    if (input == NULL)
-    {
-      printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
-      return 1;
-    }
-    convertToLowercaseAndTrim(input);
-    if (strlen(input) == 0 || strspn(input, " ") == strlen(input))
-    {
-      printf(WRONG_HANDCARDS_NUMBER);
-      free(input);
-      continue;
-    }
-    if (strncmp(input, QUIT_ACTION, 4) == 0)
+    if (points[i] > first_points)
     {
-      if (strlen(input) > 4)
-      {
-        printf(WRONG_PARAMETERS_COUNT);
-        free(input);
-        continue;
-      }
-      free(input);
-      return 1;
+      second_points = first_points;
+      first_points = points[i];
+      winners = 0;
     }
-    else if (stringToInt(input) < 1 || stringToInt(input) > 120)
-    {
-      printf(WRONG_HANDCARDS_NUMBER);
-      free(input);
-      continue;
-    }
-    card_number = stringToInt(input);
-    chosen_card = getCardFromHand(*player_handcards, card_number);
-    if (chosen_card == NULL)
+    else if (points[i] > second_points)
     {
-      printf(WRONG_HANDCARDS_NUMBER);
+      second_points = points[i];
     }
-    else
+    if (points[i] == first_points)
     {
-      free(input);
-      break;
+      winners |= (uint64_t)1 << i;
     }
-    free(input);
-  } while (TRUE);
-  if (chosen_card != NULL)
-  {
-    removeCardFromHand(player_handcards, chosen_card);
-    addCardToChosen(player_chosencards, chosen_card);
   }
-  else
+  // On a tie the second rank has the same points as the first one
+  if (winners & (winners - 1))
   {
-    printf("Error: Chosen card is NULL\n");
+    second_points = first_points;
   }
-  return 0;
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  record->deck_hash_ = deck_hash;
+  // Games that take longer than an hour are stored with the longest duration a record can hold
+  long long duration_us = (getMonotonicTimeNs() - start_ns) / 1000;
+  record->duration_us_ = duration_us < UINT32_MAX ? (uint32_t)duration_us : UINT32_MAX;
+  record->finished_time_ms_ = (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+  record->winners_ = winners;
+  record->first_points_ = first_points;
+  record->second_points_ = second_points;
+  record->players_count_ = (uint32_t)players_count;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function adds a card to the chosen cards of a player. It adds the card to the correct position in the list
-/// based on its value, keeping the list in ascending order.
+/// This function adds a record to a batch of the journal. The batch is written once it is full or once its first
+/// record has waited for the sync interval. Nothing is added if the journal is not open.
 ///
-/// @param player_chosencard The chosen cards of the player
-/// @param card The card to add
+/// @param journal The journal
+/// @param batch The batch of the calling thread
+/// @param record The record to add
 ///
 /// @return void
 //
-void addCardToChosen(Card **player_chosencard, Card *card)
+void addJournalRecord(Journal *journal, JournalBatch *batch, const JournalRecord *record)
 {
-  if (*player_chosencard == NULL || (*player_chosencard)->color_ == '\0')
+  if (journal->fd_ < 0)
   {
-    *player_chosencard = card;
-    (*player_chosencard)->next_ = NULL;
     return;
   }
-  Card *head = *player_chosencard;
-  Card *prev = NULL;
-  while (head != NULL && card->value_ > head->value_)
-  {
-    prev = head;
-    head = head->next_;
-  }
-  if (prev == NULL)
-  {
-    // Insert at the beginning of the list
-    card->next_ = *player_chosencard;
-    *player_chosencard = card;
-  }
-  else
+  if (batch->records_count_ == 0)
   {
-    // Insert in the middle or at the end of the list
-    prev->next_ = card;
-    card->next_ = head;
+    batch->first_record_ns_ = getMonotonicTimeNs();
   }
+  encodeJournalRecord(record, batch->data_ + (size_t)batch->records_count_ * JOURNAL_RECORD_SIZE);
+  batch->records_count_++;
+  flushJournalBatch(journal, batch, FALSE);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function removes a card from the chosen cards of a player. It loops through the list and removes the card if
-/// it is found. It returns 0 if the card could be removed and 1 otherwise.
+/// This function writes a batch to the journal if it is full, if its first record has waited for the sync interval or
+/// if it is forced to. Once the batch is empty, records that were written but not flushed to the disk for the sync
+/// interval are flushed as well, so a server that calls this function regularly keeps its journal up to date while no
+/// games end. Adding a record to a batch that is not written does not touch the shared state of the journal.
 ///
-/// @param player_chosencards The chosen cards of the player
-/// @param card The card to remove
+/// @param journal The journal
+/// @param batch The batch to write
+/// @param force TRUE to write the batch no matter how long its records have waited
 ///
-/// @return
-///      0 if the card could be removed
-///      1 if the card could not be removed
+/// @return void
 //
-int removeCardFromChosen(Card **player_chosencards, Card *card)
+void flushJournalBatch(Journal *journal, JournalBatch *batch, int force)
 {
-  if (*player_chosencards == NULL)
+  if (journal->fd_ < 0)
   {
-    return 1;
+    return;
   }
-  if ((*player_chosencards)->value_ == card->value_)
+  long long now_ns = getMonotonicTimeNs();
+  if (batch->records_count_ > 0 && (force || batch->records_count_ == JOURNAL_BATCH_RECORDS ||
+                                    now_ns - batch->first_record_ns_ >= journal->sync_interval_ns_))
   {
-    *player_chosencards = card->next_;
-    card->next_ = NULL;
-    return 0;
+    writeJournalBatch(journal, batch);
   }
-  Card *head = *player_chosencards;
-  while (head->next_ != NULL && head->next_ != card)
+  if (batch->records_count_ > 0)
   {
-    head = head->next_;
+    return;
   }
-  if (head->next_ != NULL)
+  pthread_mutex_lock(&journal->mutex_);
+  if (journal->unsynced_ && now_ns - journal->last_sync_ns_ >= journal->sync_interval_ns_)
   {
-    head->next_ = card->next_;
-    card->next_ = NULL;
-    return 0;
+    if (fdatasync(journal->fd_) != 0)
+    {
+      journal->error_ = 1;
+    }
+    journal->unsynced_ = FALSE;
+    journal->last_sync_ns_ = now_ns;
   }
-  return 1;
+  pthread_mutex_unlock(&journal->mutex_);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function adds a card to the hand cards of a player. It adds the card to list in a way that keeps the list in
-/// ascending order.
+/// This function appends all records of a batch to the journal with as few calls as possible and empties the batch.
+/// The journal is opened in append mode, so batches of other processes are never interleaved with a record.
 ///
-/// @param player_handcards The hand cards of the player
-/// @param card The card to add
+/// @param journal The journal
+/// @param batch The batch to write
 ///
 /// @return
-///      0 if the card could be added
-///      1 if the card could not be added
+///      0 if the batch was written
+///      1 if the batch could not be written
 //
-int addCardToHand(Card **player_handcards, Card *card)
+int writeJournalBatch(Journal *journal, JournalBatch *batch)
 {
-  Card *head = *player_handcards;
-  if (head == NULL)
-  {
-    *player_handcards = card;
-    (*player_handcards)->next_ = NULL;
-    return 0;
-  }
-  while (head != NULL)
+  size_t length = (size_t)batch->records_count_ * JOURNAL_RECORD_SIZE;
+  size_t written = 0;
+  pthread_mutex_lock(&journal->mutex_);
+  while (written < length)
   {
-    if (head->next_ == NULL)
+    ssize_t bytes_written = write(journal->fd_, batch->data_ + written, length - written);
+    if (bytes_written < 0 && errno == EINTR)
     {
-      head->next_ = card;
-      card->next_ = NULL;
-      return 0;
+      continue;
     }
-    head = head->next_;
+    if (bytes_written <= 0)
+    {
+      journal->error_ = 1;
+      break;
+    }
+    written += bytes_written;
   }
-  return 1;
+  journal->unsynced_ = TRUE;
+  int error = journal->error_;
+  pthread_mutex_unlock(&journal->mutex_);
+  batch->records_count_ = 0;
+  return error;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function removes a card from the hand cards of a player. It loops through the list and removes the card if it
-/// is found. It returns 0 if the card could be removed and 1 otherwise.
+/// This function stores a record in JOURNAL_RECORD_SIZE bytes: the deck hash and the duration in microseconds in four
+/// bytes each, the time the game finished and the winners in eight bytes each, the points of the first two ranks and
+/// the number of players in four bytes each and a checksum of all of these in the last four bytes.
 ///
-/// @param player_handcards The hand cards of the player
-/// @param card The card to remove
+/// @param record The record to store
+/// @param bytes Output parameter for the bytes of the record
 ///
-/// @return
-///      0 if the card could be removed
-///      1 if the card could not be removed
+/// @return void
 //
-int removeCardFromHand(Card **player_handcards, Card *card)
+void encodeJournalRecord(const JournalRecord *record, unsigned char *bytes)
 {
-  if (*player_handcards == NULL)
-  {
-    return 1;
-  }
-  else if ((*player_handcards)->value_ == card->value_)
-  {
-    *player_handcards = card->next_;
-    card->next_ = NULL;
-    return 0;
-  }
-  Card *head = *player_handcards;
-  while (head->next_ != NULL && head->next_ != card)
-  {
-    head = head->next_;
-  }
-  if (head->next_ != NULL)
-  {
-    head->next_ = card->next_;
-    card->next_ = NULL;
-    return 0;
-  }
-  return 1;
+  writeLittleEndian(bytes, record->deck_hash_, 4);
+  writeLittleEndian(bytes + 4, record->duration_us_, 4);
+  writeLittleEndian(bytes + 8, record->finished_time_ms_, 8);
+  writeLittleEndian(bytes + 16, record->winners_, 8);
+  writeLittleEndian(bytes + 24, (uint32_t)record->first_points_, 4);
+  writeLittleEndian(bytes + 28, (uint32_t)record->second_points_, 4);
+  writeLittleEndian(bytes + 32, record->players_count_, 4);
+  writeLittleEndian(bytes + 36, hashBytes(bytes, JOURNAL_RECORD_SIZE - 4), 4);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function adds a card to a row of cards of a player. It adds the card to the correct position in the list based
-/// on its value, keeping the list in ascending order. It uses the row number to determine the correct row.
-/// The card can only be added if the card can be added at the beginning or end of the row.
+/// This function reads a record that was stored by encodeJournalRecord and checks its checksum.
 ///
-/// @param player_cardrows The card rows of the player
-/// @param card The card to add
-/// @param row_number The row number to add the card to
+/// @param bytes The bytes of the record
+/// @param record Output parameter for the record
 ///
 /// @return
-///      0 if the card could be added
-///      1 if the card could not be added
+///      0 if the record is intact
+///      3 if the record is damaged
 //
-int addCardToRow(Card **player_cardrows, Card *card, int row_number)
+int decodeJournalRecord(const unsigned char *bytes, JournalRecord *record)
 {
-  card->next_ = NULL;
-  Card *current = player_cardrows[row_number];
-  Card *prev = NULL;
-  if (current == NULL)
-  {
-    player_cardrows[row_number] = card;
-    return 0;
-  }
-  if (card->value_ < current->value_)
-  {
-    card->next_ = current;
-    player_cardrows[row_number] = card;
-    return 0;
-  }
-  while (current != NULL && card->value_ > current->value_)
+  if (readLittleEndian(bytes + 36, 4) != hashBytes(bytes, JOURNAL_RECORD_SIZE - 4))
   {
-    prev = current;
-    current = current->next_;
+    return INVALID_FILE;
   }
-  if (current == NULL)
+  record->deck_hash_ = (uint32_t)readLittleEndian(bytes, 4);
+  record->duration_us_ = (uint32_t)readLittleEndian(bytes + 4, 4);
+  record->finished_time_ms_ = readLittleEndian(bytes + 8, 8);
+  record->winners_ = readLittleEndian(bytes + 16, 8);
+  record->first_points_ = (int32_t)(uint32_t)readLittleEndian(bytes + 24, 4);
+  record->second_points_ = (int32_t)(uint32_t)readLittleEndian(bytes + 28, 4);
+  record->players_count_ = (uint32_t)readLittleEndian(bytes + 32, 4);
+  if (record->players_count_ < MIN_PLAYERS || record->players_count_ > MAX_PLAYERS)
   {
-    prev->next_ = card;
-    return 0;
+    return INVALID_FILE;
   }
-  return 1;
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function swaps two cards. This is useful to sort them properly and only acts as a helper function.
+/// This function computes a FNV-1a hash of a sequence of bytes.
 ///
-/// @param first_card The first card to swap
-/// @param second_card The second card to swap
+/// @param bytes The bytes to hash
+/// @param length The number of bytes
 ///
-/// @return void
+/// @return
+///      the hash of the bytes
 //
-void swapCards(Card **first_card, Card **second_card)
+uint32_t hashBytes(const unsigned char *bytes, size_t length)
 {
-  Color temp_color = (*first_card)->color_;
-  int temp_value = (*first_card)->value_;
-  (*first_card)->color_ = (*second_card)->color_;
-  (*first_card)->value_ = (*second_card)->value_;
-  (*second_card)->color_ = temp_color;
-  (*second_card)->value_ = temp_value;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++)
+  {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function sorts the cards of a player. It uses the bubble sort algorithm to sort the cards in ascending order.
+/// This function runs the journal summary mode. The journal is read in large blocks and all records are added up in a
+/// single pass: the games, the wins of every player, the ties, the points of the winners and the durations. Damaged
+/// records and a record that was cut off at the end of the journal are counted and skipped.
 ///
-/// @param player_cards The cards of the player
+/// @param options The parsed command line options
 ///
 /// @return
-///      0 if the cards could be sorted
-///      1 if the cards could not be sorted
+///      0 if the journal was summarized
+///      2 if the journal could not be opened
+///      3 if the journal is invalid
+///      4 if there was a memory allocation error
 //
-int sortCards(Card **player_cards)
+int runJournalSummary(const Options *options)
 {
-  if (*player_cards == NULL || (*player_cards)->next_ == NULL)
+  FILE *file = fopen(options->journal_summary_file_, "rb");
+  if (file == NULL)
   {
-    return 1;
+    printf("Error: Cannot open file: %s\n", options->journal_summary_file_);
+    return CANNOT_OPEN_FILE;
   }
-  int swapped;
-  Card *ptr1;
-  Card *lptr = NULL;
-  do
+  unsigned char header[JOURNAL_HEADER_SIZE];
+  if (fread(header, 1, JOURNAL_HEADER_SIZE, file) != JOURNAL_HEADER_SIZE ||
+      memcmp(header, JOURNAL_MAGIC, strlen(JOURNAL_MAGIC)) != 0 || readLittleEndian(header + 4, 2) != JOURNAL_VERSION ||
+      readLittleEndian(header + 6, 2) != JOURNAL_RECORD_SIZE)
+  {
+    printf("Error: Invalid file: %s\n", options->journal_summary_file_);
+    fclose(file);
+    return INVALID_FILE;
+  }
+  unsigned char *buffer = malloc((size_t)JOURNAL_READ_RECORDS * JOURNAL_RECORD_SIZE);
+  if (buffer == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    fclose(file);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  long long start_ns = getMonotonicTimeNs();
+  long games_count = 0;
+  long ties_count = 0;
+  long damaged_count = 0;
+  long wins[MAX_PLAYERS] = {0};
+  int players_count = 0;
+  long long first_points = 0;
+  long long margins = 0;
+  long long durations_us = 0;
+  size_t bytes_read;
+  while ((bytes_read = fread(buffer, 1, (size_t)JOURNAL_READ_RECORDS * JOURNAL_RECORD_SIZE, file)) > 0)
   {
-    swapped = 0;
-    ptr1 = *player_cards;
-    while (ptr1->next_ != lptr)
+    size_t records_count = bytes_read / JOURNAL_RECORD_SIZE;
+    // Only the last block can end within a record, which is a record that was cut off by a crash
+    if (bytes_read % JOURNAL_RECORD_SIZE != 0)
     {
-      if (ptr1->value_ > ptr1->next_->value_)
+      damaged_count++;
+    }
+    for (size_t i = 0; i < records_count; i++)
+    {
+      JournalRecord record;
+      if (decodeJournalRecord(buffer + i * JOURNAL_RECORD_SIZE, &record) != 0)
+      {
+        damaged_count++;
+        continue;
+      }
+      games_count++;
+      if ((int)record.players_count_ > players_count)
+      {
+        players_count = (int)record.players_count_;
+      }
+      // A game with more than one winner is a tie and counts as a win for none of them
+      if (record.winners_ & (record.winners_ - 1))
+      {
+        ties_count++;
+      }
+      else
       {
-        swapCards(&ptr1, &(ptr1->next_));
-        swapped = 1;
+        for (int player = 0; player < (int)record.players_count_; player++)
+        {
+          wins[player] += (record.winners_ >> player) & 1;
+        }
       }
-      ptr1 = ptr1->next_;
+      first_points += record.first_points_;
+      margins += record.first_points_ - record.second_points_;
+      durations_us += record.duration_us_;
     }
-    lptr = ptr1;
-  } while (swapped);
+  }
+  fclose(file);
+  free(buffer);
+  double seconds = (getMonotonicTimeNs() - start_ns) / 1e9;
+  printf("Summarized %ld games in %.3f s (%.0f games/s)\n", games_count, seconds,
+         seconds > 0 ? games_count / seconds : 0.0);
+  for (int i = 0; i < players_count; i++)
+  {
+    printf("Player %i: %ld wins\n", i + 1, wins[i]);
+  }
+  printf("Ties: %ld, damaged records: %ld\n", ties_count, damaged_count);
+  if (games_count > 0)
+  {
+    printf("Winner: %.2f points on average, %.2f points ahead on average\n", (double)first_points / games_count,
+           (double)margins / games_count);
+    printf("Duration: %.3f ms on average\n", durations_us / 1000.0 / games_count);
+  }
   return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function simulates the action phase. It starts with the first player and lets him choose a card from his chosen
-/// cards and add it to one of his card rows. Then it does the same for the second player. It returns 0 if the action
-/// phase could be performed successfully and 1 otherwise.
+/// This function maps an opening book into memory. The mapping is read-only and shared, so processes that use the same
+/// book share its pages and nothing is read before a probe touches it. The book stays mapped until the program ends.
 ///
-/// @param player_one_handcards The hand cards of the first player
-/// @param player_one_chosencards The chosen cards of the first player
-/// @param player_one_cardrows The card rows of the first player
-/// @param player_two_handcards The hand cards of the second player
-/// @param player_two_chosencards The chosen cards of the second player
-/// @param player_two_cardrows The card rows of the second player
+/// @param book The book to map
+/// @param book_file The path to the book file
 ///
 /// @return
-///      0 if the action phase could be performed successfully
-///      1 if the action phase could not be performed successfully
+///      0 if the book was mapped
+///      2 if the file could not be opened or mapped
+///      3 if the file is no opening book
 //
-int actionChoosingPhase(Card **player_one_handcards, Card **player_one_chosencards, Card ***player_one_cardrows,
-                        Card **player_two_handcards, Card **player_two_chosencards, Card ***player_two_cardrows)
+int openOpeningBook(OpeningBook *book, const char *book_file)
 {
-  printPlayer(1, player_one_handcards, player_one_chosencards, player_one_cardrows);
-  if (actionChoosingLoop(1, player_one_handcards,
-                         player_one_chosencards, player_one_cardrows) == 1)
+  int fd = open(book_file, O_RDONLY);
+  if (fd < 0)
   {
-    return 1;
+    printf("Error: Cannot open file: %s\n", book_file);
+    return CANNOT_OPEN_FILE;
   }
-  printf("\n");
-  printPlayer(2, player_two_handcards, player_two_chosencards, player_two_cardrows);
-  if (actionChoosingLoop(2, player_two_handcards,
-                         player_two_chosencards, player_two_cardrows) == 1)
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < OPENING_BOOK_HEADER_SIZE)
   {
-    return 1;
+    printf("Error: Invalid file: %s\n", book_file);
+    close(fd);
+    return INVALID_FILE;
   }
-  printf("\n");
-  printf(ACTION_PHASE_IS_OVER);
-  printf("\n");
+  void *data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    printf("Error: Cannot open file: %s\n", book_file);
+    return CANNOT_OPEN_FILE;
+  }
+  const unsigned char *header = data;
+  uint64_t capacity = readLittleEndian(header + 8, 4);
+  // The capacity is a power of two, so a key is reduced to a slot with a mask
+  if (memcmp(header, OPENING_BOOK_MAGIC, strlen(OPENING_BOOK_MAGIC)) != 0 ||
+      readLittleEndian(header + 4, 2) != OPENING_BOOK_VERSION ||
+      readLittleEndian(header + 6, 2) != OPENING_BOOK_ENTRY_SIZE || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+      (uint64_t)file_stat.st_size != OPENING_BOOK_HEADER_SIZE + capacity * OPENING_BOOK_ENTRY_SIZE)
+  {
+    printf("Error: Invalid file: %s\n", book_file);
+    munmap(data, (size_t)file_stat.st_size);
+    return INVALID_FILE;
+  }
+  book->data_ = data;
+  book->size_ = (size_t)file_stat.st_size;
+  book->capacity_ = (uint32_t)capacity;
   return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function checks if the input for the action phase is correct. It checks if the row number and the card number
-/// are valid. It returns true if the input is correct and false otherwise.
+/// This function computes the key of a hand in the opening book. The hand cards are sorted by value, so the same
+/// cards with the same colors always give the same key. The cards that were already chosen follow behind a separator,
+/// so a hand after the first keep has a key of its own. The key 0 marks an empty slot and is never returned.
 ///
-/// @param row_number The row number to check
-/// @param card_number The card number to check
+/// @param player The player whose hand is hashed
 ///
 /// @return
-///      true if the input is correct
-///      false if the input is incorrect
+///      the key of the hand
 //
-int isActionInputCorrect(char *row_number, const char *card_number)
+uint64_t hashOpeningHand(const Player *player)
 {
-  if ((row_number == NULL || card_number == NULL) || strtok(NULL, " ") != NULL)
-  {
-    printf(WRONG_PARAMETERS_COUNT);
-    return FALSE;
-  }
-  else if (stringToInt(row_number) > 3 || stringToInt(row_number) < 1)
+  uint64_t hash = 0;
+  for (const Card *card = player->handcards_; card != NULL; card = card->next_)
   {
-    printf(WRONG_ROW_NUMBER);
-    return FALSE;
+    hash ^= (uint64_t)card->value_ << 8 | (uint64_t)card->color_;
+    hash = nextRandom(&hash);
   }
-  else
+  hash = nextRandom(&hash);
+  for (const Card *card = player->chosencards_; card != NULL; card = card->next_)
   {
-    return TRUE;
+    hash ^= (uint64_t)card->value_ << 8 | (uint64_t)card->color_;
+    hash = nextRandom(&hash);
   }
+  return hash != 0 ? hash : 1;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// A helper function to convert a given string to all lowercase and trim away unnecessary whitespaces.
+/// This function looks up the cards to keep in the first choosing phase in the opening book. Only the hands of the
+/// first round are in the book, so other hands are not looked up at all.
 ///
-/// @param str The string to convert
+/// @param book The opening book, it may not be mapped
+/// @param player The player that chooses a card
+/// @param move Output parameter for the cards to keep
 ///
-/// @return void
+/// @return
+///      TRUE if the hand was found in the book
+///      FALSE if it was not found
 //
-void convertToLowercaseAndTrim(char *str)
+int probeOpeningBook(const OpeningBook *book, const Player *player, SearchMove *move)
 {
-  // Convert only alphabetic characters to lowercase
-  for (int i = 0; str[i]; i++)
-  {
-    str[i] = tolower((unsigned char)str[i]);
-  }
-  // Remove leading whitespaces
-  int start = 0;
-  while (isspace((unsigned char)str[start]))
+  if (book->data_ == NULL)
   {
-    start++;
+    return FALSE;
   }
-  // Remove trailing whitespaces
-  int end = strlen(str) - 1;
-  while (end >= 0 && isspace((unsigned char)str[end]))
+  int handcards_count = countCards(player->handcards_);
+  int chosencards_count = countCards(player->chosencards_);
+  if (handcards_count + chosencards_count != HAND_SIZE || chosencards_count >= CARDS_TO_KEEP)
   {
-    end--;
+    return FALSE;
   }
-  // Shift the non-whitespace characters to the beginning
-  int i, j;
-  for (i = start, j = 0; i <= end; i++, j++)
+  uint64_t key = hashOpeningHand(player);
+  uint32_t mask = book->capacity_ - 1;
+  // The table of a book that was written by writeOpeningBook always has empty slots, a damaged one may not
+  for (uint32_t probe = 0; probe < book->capacity_; probe++)
   {
-    str[j] = str[i];
+    uint32_t slot = ((uint32_t)key + probe) & mask;
+    OpeningBookEntry entry;
+    decodeOpeningBookEntry(book->data_ + OPENING_BOOK_HEADER_SIZE + (size_t)slot * OPENING_BOOK_ENTRY_SIZE, &entry);
+    if (entry.key_ == 0)
+    {
+      return FALSE;
+    }
+    if (entry.key_ == key)
+    {
+      move->values_count_ = CARDS_TO_KEEP - chosencards_count;
+      move->row_number_ = -1;
+      for (int i = 0; i < move->values_count_; i++)
+      {
+        move->values_[i] = entry.values_[i];
+        // A key that collides with another hand is no hit
+        if (getCardFromHand(player, entry.values_[i]) == NULL)
+        {
+          return FALSE;
+        }
+      }
+      return TRUE;
+    }
   }
-  // Null-terminate the string
-  str[j] = '\0';
+  return FALSE;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function performs the action choosing phase. It starts with the first player and lets him choose a card from
-/// his chosen cards and add it to one of his card rows. Then it does the same for the second player. It returns 0 if
-/// the action choosing phase could be performed successfully and 1 otherwise.
+/// This function stores an entry of the opening book in little endian order: the key in 8 bytes, both card values in
+/// 1 byte each, 2 unused bytes and the expected point margin in hundredths of a point in 4 bytes.
 ///
-/// @param player_id The number of the player
-/// @param player_handcards The hand cards of the player
-/// @param player_chosencards The chosen cards of the player
-/// @param player_cardrows The card rows of the player
+/// @param entry The entry to store
+/// @param bytes Output parameter for the bytes, it has to hold OPENING_BOOK_ENTRY_SIZE bytes
 ///
-/// @return
-///      0 if the action choosing phase could be performed successfully
-///      1 if the action choosing phase could not be performed successfully
+/// @return void
 //
-int actionChoosingLoop(int player_id, Card **player_handcards, Card **player_chosencards, Card ***player_cardrows)
+void encodeOpeningBookEntry(const OpeningBookEntry *entry, unsigned char *bytes)
 {
-  int skip_prompt = FALSE;
-  do
-  {
-    if (!skip_prompt)
-    {
-      printf(PROMPT_PLAYER_ACTION);
-    }
-    printf("P%i > ", player_id);
-    char *input = readInput();
-    // Convert the input to lowercase
-    convertToLowercaseAndTrim(input);
-    if (strncmp(input, QUIT_ACTION, 4) == 0)
-    {
-      if (strlen(input) > 4)
-      {
-        printf(WRONG_PARAMETERS_COUNT);
-        skip_prompt = TRUE;
-        free(input);
-        continue;
-      }
-      free(input);
-      return 1;
-    }
-    else if (strncmp(input, PLACE_ACTION, 5) == 0 && strlen(input) >= 5)
-    {
-     if (placeAction(input, &skip_prompt, player_id, player_handcards, player_chosencards, player_cardrows) == 1)
-     {
-       free(input);
-       continue;
-     }
-    }
-    else if (strncmp(input, DISCARD_ACTION, 7) == 0 && strlen(input) >= 7)
-    {
-      if (discardAction(input, &skip_prompt, player_id, player_handcards, player_chosencards, player_cardrows) == 1)
-      {
-        free(input);
-        continue;
-      }
-    }
-    else if (strncmp(input, HELP_ACTION, 4) == 0)
-    {
-      if (strlen(input) > 4)
-      {
-        printf(WRONG_PARAMETERS_COUNT);
-        skip_prompt = TRUE;
-        free(input);
-        continue;
-      }
-      helpAction(player_id, player_handcards, player_chosencards, player_cardrows);
-    }
-    else
-    {
-      printf(INVALID_COMMAND);
-      skip_prompt = TRUE;
-      free(input);
-      continue;
-    }
-    skip_prompt = FALSE;
-    free(input);
-  } while (*player_chosencards != NULL);
-  return 0;
+  writeLittleEndian(bytes, entry->key_, 8);
+  writeLittleEndian(bytes + 8, (uint64_t)entry->values_[0], 1);
+  writeLittleEndian(bytes + 9, (uint64_t)entry->values_[1], 1);
+  writeLittleEndian(bytes + 10, 0, 2);
+  writeLittleEndian(bytes + 12, (uint32_t)entry->margin_, 4);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function prints the help message for the action phase.
+/// This function reads an entry of the opening book that was stored by encodeOpeningBookEntry.
 ///
-/// @param player_id The number of the player
-/// @param player_handcards The hand cards of the player
-/// @param player_chosencards The chosen cards of the player
-/// @param player_cardrows The card rows of the player
+/// @param bytes The bytes of the entry
+/// @param entry Output parameter for the entry
 ///
 /// @return void
 //
-void helpAction(int player_id, Card **player_handcards, Card **player_chosencards, Card ***player_cardrows)
-{
-  printf("\n"
-         "Available commands:\n"
-         "\n"
-         "- help\n"
-         "  Display this help message.\n"
-         "\n"
-         "- place <row number> <card number>\n"
-         "  Append a card to the chosen row or if the chosen row does not exist create it.\n"
-         "\n"
-         "- discard <card number>\n"
-         "  Discard a card from the chosen cards.\n"
-         "\n"
-         "- quit\n"
-         "  Terminate the program.\n"
-         "\n");
-  printf("\n");
-  printPlayer(player_id, player_handcards, player_chosencards, player_cardrows);
+void decodeOpeningBookEntry(const unsigned char *bytes, OpeningBookEntry *entry)
+{
+  entry->key_ = readLittleEndian(bytes, 8);
+  entry->values_[0] = (int)readLittleEndian(bytes + 8, 1);
+  entry->values_[1] = (int)readLittleEndian(bytes + 9, 1);
+  entry->margin_ = (int32_t)(uint32_t)readLittleEndian(bytes + 12, 4);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function performs the place action. It checks if the input is correct and if the card can be added to the
-/// chosen row. It returns 0 if the place action could be performed successfully and 1 otherwise.
+/// This function builds an opening book from the decks of a deck list, which is read like the one of a tournament.
+/// For the starting hand of both players of every deck all pairs of cards to keep are played out the given number of
+/// times with the playout strategy, every pair with the same random seeds. The pair with the best average point
+/// margin is stored for the full hand and, for a bot that keeps one card at a time, for the hands after each of its
+/// two cards was kept. The decks are spread over one worker thread per core.
 ///
-/// @param input The input string
-/// @param skip_prompt A pointer to a boolean that indicates if the prompt should be skipped
-/// @param player_id The number of the player
-/// @param player_handcards The hand cards of the player
-/// @param player_chosencards The chosen cards of the player
-/// @param player_cardrows The card rows of the player
+/// @param options The parsed command line options
 ///
 /// @return
-///      0 if the place action could be performed successfully
-///      1 if the place action could not be performed successfully
+///      0 if the book was built
+///      2 if the deck list or a config file could not be opened or the book could not be written
+///      3 if the deck list or one of its config files is invalid
+///      4 if there was a memory allocation error
 //
-int placeAction(char *input, int *skip_prompt, int player_id, Card **player_handcards,
-                Card **player_chosencards, Card ***player_cardrows)
+int runBookBuilder(const Options *options)
 {
-  char *input_copy = duplicateString(input);
-  if (input_copy == NULL)
+  BookBuilder builder;
+  int deck_error = loadTournamentDecks(options->config_file_, &builder.decks_);
+  if (deck_error != 0)
   {
-    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
-    return 1;
+    return deck_error;
   }
-  char *row_number = strtok(input_copy + 5, " ");
-  char *card_number = strtok(NULL, " ");
-  char *rest_of_input = strtok(NULL, "");
-  if (rest_of_input != NULL || row_number == NULL || card_number == NULL)
+  builder.games_ = options->book_games_;
+  atomic_init(&builder.next_deck_, 0);
+  int entries_count = builder.decks_.decks_count_ * 2 * OPENING_BOOK_HAND_ENTRIES;
+  builder.entries_ = calloc(entries_count, sizeof(OpeningBookEntry));
+  long threads_count = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads_count < 1)
   {
-    printf(WRONG_PARAMETERS_COUNT);
-    *skip_prompt = TRUE;
-    free(input_copy);
-    return 1;
+    threads_count = 1;
   }
-  if (isActionInputCorrect(row_number, card_number))
+  if (threads_count > builder.decks_.decks_count_)
   {
-    int card_number_int = stringToInt(card_number);
-    Card *choosen_card = getCardFromChosen(*player_chosencards, card_number_int);
-    if (choosen_card == NULL)
-    {
-      printf(WRONG_CHOSENCARDS_NUMBER);
-      *skip_prompt = TRUE;
-      free(input_copy);
-      return 1;
-    }
-    else
+    threads_count = builder.decks_.decks_count_;
+  }
+  if (threads_count > MAX_SIMULATION_THREADS)
+  {
+    threads_count = MAX_SIMULATION_THREADS;
+  }
+  BookWorker *workers = calloc(threads_count, sizeof(BookWorker));
+  if (builder.entries_ == NULL || workers == NULL)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    free(builder.entries_);
+    free(workers);
+    freeTournamentDecks(&builder.decks_);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  long long start_ns = getMonotonicTimeNs();
+  long started_count = 0;
+  for (long i = 0; i < threads_count; i++)
+  {
+    workers[i].builder_ = &builder;
+    if (pthread_create(&workers[i].thread_, NULL, bookWorker, &workers[i]) != 0)
     {
-      removeCardFromChosen(player_chosencards, choosen_card);
-      int row_number_int = stringToInt(row_number) - 1;
-      int result = addCardToRow(*player_cardrows, choosen_card, row_number_int);
-      if (result == 1)
-      {
-        printf(CARD_CANNOT_EXTEND_ROW);
-        *skip_prompt = TRUE;
-        addCardToChosen(player_chosencards, choosen_card);
-        free(input_copy);
-        return 1;
-      }
-      printf("\n");
-      printPlayer(player_id, player_handcards, player_chosencards, player_cardrows);
+      break;
     }
+    started_count++;
   }
-  else
+  for (long i = 0; i < started_count; i++)
   {
-    free(input_copy);
-    *skip_prompt = TRUE;
-    return 1;
+    pthread_join(workers[i].thread_, NULL);
   }
-  free(input_copy);
-  return 0;
-}
-
-//---------------------------------------------------------------------------------------------------------------------
-///
-/// This function performs the discard action. It checks if the input is correct and if the card can be discarded. It
-/// returns 0 if the discard action could be performed successfully and 1 otherwise.
-///
-/// @param input The input string
-/// @param skip_prompt A pointer to a boolean that indicates if the prompt should be skipped
-/// @param player_id The number of the player
-/// @param player_handcards The hand cards of the player
-/// @param player_chosencards The chosen cards of the player
-/// @param player_cardrows The card rows of the player
-///
-/// @return
-///      0 if the discard action could be performed successfully
-///      1 if the discard action could not be performed successfully
-//
-int discardAction(char *input, int *skip_prompt, int player_id, Card **player_handcards,
-                  Card **player_chosencards, Card ***player_cardrows)
-{
-  char *card_number = strtok(input + 7, " ");
-  char *rest_of_input = strtok(NULL, "");
-  if (rest_of_input != NULL || card_number == NULL)
+  if (started_count == 0)
   {
-    printf(WRONG_PARAMETERS_COUNT);
-    *skip_prompt = TRUE;
-    return 1;
+    bookWorker(&workers[0]);
+    started_count = 1;
   }
-  Card *choosen_card = getCardFromChosen(*player_chosencards, stringToInt(card_number));
-  if (choosen_card == NULL)
+  int error = 0;
+  for (long i = 0; i < started_count; i++)
   {
-    printf(WRONG_CHOSENCARDS_NUMBER);
-    *skip_prompt = TRUE;
-    return 1;
+    error |= workers[i].error_;
   }
-  else
+  free(workers);
+  int decks_count = builder.decks_.decks_count_;
+  freeTournamentDecks(&builder.decks_);
+  int hands_count = 0;
+  if (error == 0)
   {
-    removeCardFromChosen(player_chosencards, choosen_card);
-    free(choosen_card);
-    printf("\n");
-    printPlayer(player_id, player_handcards, player_chosencards, player_cardrows);
+    error = writeOpeningBook(options->build_book_file_, builder.entries_, entries_count, &hands_count);
+  }
+  free(builder.entries_);
+  if (error == MEMORY_ALLOCATION_ERROR)
+  {
+    printf(MEMORY_ALLOCATION_ERROR_MESSAGE);
+    return error;
+  }
+  if (error != 0)
+  {
+    printf("Error: Cannot open file: %s\n", options->build_book_file_);
+    return error;
   }
+  printf("Built an opening book with %d hands from %d decks in %.3f s\n", hands_count, decks_count,
+         (getMonotonicTimeNs() - start_ns) / 1e9);
   return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function performs the game end phase. It calculates the points of the given player and returns the total.
+/// This is the entry point of a book builder thread. It takes one deck at a time until all decks are done and finds
+/// the best cards to keep for the starting hands of both players. The thread reuses one card arena for all playouts.
 ///
-/// @param player_cardrows The card row of the player
+/// @param argument The BookWorker of this thread
 ///
-/// @return
-///      The total points of the player
+/// @return NULL
 //
-int calculatePlayerPoints(Card ***player_cardrows)
+void *bookWorker(void *argument)
 {
-  int points = 0;
-  int longest_row_length = 0;
-  int longest_row_index = -1;
-  // Find the longest row and its index
-  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  BookWorker *worker = argument;
+  BookBuilder *builder = worker->builder_;
+  if (initCardArena(&worker->arena_, DECK_SIZE) != 0)
   {
-    int row_length = 0;
-    Card *head = (*player_cardrows)[i];
-    while (head != NULL)
-    {
-      row_length++;
-      head = head->next_;
-    }
-    if (row_length > longest_row_length || (row_length == longest_row_length && i < longest_row_index))
-    {
-      longest_row_length = row_length;
-      longest_row_index = i;
-    }
+    worker->error_ = MEMORY_ALLOCATION_ERROR;
+    return NULL;
   }
-  // Calculate points, applying multiplier only to the longest row with the lowest index
-  for (int i = 0; i < MAX_CARD_ROWS; i++)
+  int deck;
+  while (worker->error_ == 0 && (deck = atomic_fetch_add(&builder->next_deck_, 1)) < builder->decks_.decks_count_)
   {
-    int row_length = 0;
-    Card *head = (*player_cardrows)[i];
-    singleRowPointsCount(head, &points, &row_length);
-    if (row_length == longest_row_length && i == longest_row_index)
+    for (int player = 0; player < 2 && worker->error_ == 0; player++)
     {
-      points *= 2;
+      OpeningBookEntry *entries = builder->entries_ + ((size_t)deck * 2 + player) * OPENING_BOOK_HAND_ENTRIES;
+      worker->error_ = findOpeningKeeps(worker, builder->decks_.decks_[deck].players_, player,
+                                        ((uint64_t)deck * 2 + player) << 32, entries);
     }
   }
-  return points;
+  freeCardArena(&worker->arena_);
+  return NULL;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function counts the points of a single row of cards. It counts the points of the cards and adds them to the
-/// total points. It also counts the length of the row and adds it to the total length.
+/// This function finds the best pair of cards a player keeps from the starting hand of a deck and fills the entries of
+/// the book for the hand: the full hand keeps both cards, and the hand after one of the cards was kept keeps the
+/// other one. The player cannot see the hand of the opponent, so it is dealt anew from the unseen values in every game.
 ///
-/// @param head The head of the row
-/// @param points A pointer to the total points
-/// @param row_length A pointer to the total length
+/// @param worker The worker that plays out the games
+/// @param deck_players Both players with the starting hands of the deck
+/// @param player_index The index of the player whose keeps are searched
+/// @param seed The first random seed of the playouts, every pair of cards is played out with the same seeds
+/// @param entries Output parameter for the OPENING_BOOK_HAND_ENTRIES entries of the hand
 ///
-/// @return void
+/// @return
+///      0 if the keeps were found
+///      4 if there was a memory allocation error
 //
-void singleRowPointsCount(Card *head, int *points, int *row_length)
+int findOpeningKeeps(BookWorker *worker, const Player *deck_players, int player_index, uint64_t seed,
+                     OpeningBookEntry *entries)
 {
-  while (head != NULL)
+  const Strategy *strategies[2] = {&PLAYOUT_STRATEGY, &PLAYOUT_STRATEGY};
+  // The book is probed with the own hand alone, so the hand of the opponent is dealt anew in every game
+  int unseen_values[MAX_CARD_VALUE];
+  int unseen_count = collectUnseenValues(&deck_players[player_index], &deck_players[1 - player_index], TRUE,
+                                         unseen_values);
+  int values[HAND_SIZE];
+  int values_count = 0;
+  for (const Card *card = deck_players[player_index].handcards_; card != NULL; card = card->next_)
   {
-    (*row_length)++;
-    if (head->color_ == RED)
-    {
-      (*points) += 10;
-    }
-    else if (head->color_ == WHITE)
+    values[values_count++] = card->value_;
+  }
+  long long best_margin = 0;
+  int best_keeps[CARDS_TO_KEEP] = {0, 0};
+  for (int first = 0; first < values_count; first++)
+  {
+    for (int second = first + 1; second < values_count; second++)
     {
-      (*points) += 7;
+      long long margin = 0;
+      for (long game = 0; game < worker->builder_->games_; game++)
+      {
+        Player players[2];
+        if (copyDeckPlayers(&worker->arena_, deck_players, players) != 0)
+        {
+          return MEMORY_ALLOCATION_ERROR;
+        }
+        keepOpeningCard(&players[player_index], values[first]);
+        keepOpeningCard(&players[player_index], values[second]);
+        uint64_t random_state = seed + (uint64_t)game;
+        // The unseen values start in the same order for every pair, so a game deals the same hand to all of them
+        int shuffled_values[MAX_CARD_VALUE];
+        memcpy(shuffled_values, unseen_values, sizeof(shuffled_values));
+        dealHiddenCards(&players[1 - player_index], TRUE, shuffled_values, unseen_count, &random_state);
+        playRemainingGame(players, strategies, PHASE_CHOOSING, 0, &random_state);
+        margin += calculatePlayerPoints(players[player_index].cardrows_) -
+                  calculatePlayerPoints(players[1 - player_index].cardrows_);
+      }
+      if ((first == 0 && second == 1) || margin > best_margin)
+      {
+        best_margin = margin;
+        best_keeps[0] = values[first];
+        best_keeps[1] = values[second];
+      }
     }
-    else if (head->color_ == GREEN)
+  }
+  int margin = (int)(best_margin * 100 / worker->builder_->games_);
+  Player players[2];
+  for (int i = 0; i < OPENING_BOOK_HAND_ENTRIES; i++)
+  {
+    if (copyDeckPlayers(&worker->arena_, deck_players, players) != 0)
     {
-      (*points) += 4;
+      return MEMORY_ALLOCATION_ERROR;
     }
-    else if (head->color_ == BLUE)
+    // The first entry is the full hand, the others are the hands after one of the cards was kept
+    if (i > 0)
     {
-      (*points) += 3;
+      keepOpeningCard(&players[player_index], best_keeps[i - 1]);
     }
-    head = head->next_;
+    entries[i].key_ = hashOpeningHand(&players[player_index]);
+    entries[i].values_[0] = i == 1 ? best_keeps[1] : best_keeps[0];
+    entries[i].values_[1] = i == 0 ? best_keeps[1] : 0;
+    entries[i].margin_ = margin;
   }
+  return 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function frees the memory of a player. It frees the hand cards, the chosen cards and the card rows of the
-/// player.
+/// A helper function that moves a hand card of a player to the chosen cards.
 ///
-/// @param player_handcards The hand cards of the player
-/// @param player_chosencards The chosen cards of the player
-/// @param player_cardrows The card rows of the player
+/// @param player The player that keeps the card
+/// @param value The value of the card
 ///
 /// @return void
 //
-void freePlayer(Card **player_handcards, Card **player_chosencards, Card ***player_cardrows)
+void keepOpeningCard(Player *player, int value)
 {
-  freeLinkedList(*player_handcards);
-  *player_handcards = NULL;
-  freeLinkedList(*player_chosencards);
-  *player_chosencards = NULL;
-  for (int i = 0; i < MAX_CARD_ROWS; i++)
-  {
-    freeLinkedList((*player_cardrows)[i]);
-    (*player_cardrows)[i] = NULL;
-  }
-  free(*player_cardrows);
-  *player_cardrows = NULL;
+  Card *card = getCardFromHand(player, value);
+  removeCardFromHand(player, card);
+  addCardToChosen(player, card);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// This function frees a linked list of cards. It frees the memory of each card in the list.
+/// This function writes an opening book. The entries are put into an open addressing hash table with linear probing
+/// that is at most half full, so a probe rarely looks at more than one slot. A hand that is in the list more than once
+/// is stored only once.
 ///
-/// @param head The head of the list
+/// @param book_file The path to the book file, it is replaced if it exists
+/// @param entries The entries to store
+/// @param entries_count The number of entries
+/// @param hands_count Output parameter for the number of stored entries
 ///
-/// @return void
+/// @return
+///      0 if the book was written
+///      2 if the file could not be written
+///      4 if there was a memory allocation error
 //
-void freeLinkedList(Card* head)
+int writeOpeningBook(const char *book_file, const OpeningBookEntry *entries, int entries_count, int *hands_count)
 {
-  Card* temporary_card;
-  while (head != NULL)
+  uint32_t capacity = OPENING_BOOK_MIN_CAPACITY;
+  while (capacity < 2 * (uint32_t)entries_count)
   {
-    temporary_card = head;
-    head = head->next_;
-    free(temporary_card);
-    temporary_card = NULL;
+    capacity *= 2;
+  }
+  size_t size = OPENING_BOOK_HEADER_SIZE + (size_t)capacity * OPENING_BOOK_ENTRY_SIZE;
+  unsigned char *data = calloc(size, 1);
+  if (data == NULL)
+  {
+    return MEMORY_ALLOCATION_ERROR;
   }
+  memcpy(data, OPENING_BOOK_MAGIC, strlen(OPENING_BOOK_MAGIC));
+  writeLittleEndian(data + 4, OPENING_BOOK_VERSION, 2);
+  writeLittleEndian(data + 6, OPENING_BOOK_ENTRY_SIZE, 2);
+  writeLittleEndian(data + 8, capacity, 4);
+  *hands_count = 0;
+  for (int i = 0; i < entries_count; i++)
+  {
+    for (uint32_t slot = (uint32_t)entries[i].key_ & (capacity - 1);; slot = (slot + 1) & (capacity - 1))
+    {
+      unsigned char *bytes = data + OPENING_BOOK_HEADER_SIZE + (size_t)slot * OPENING_BOOK_ENTRY_SIZE;
+      uint64_t key = readLittleEndian(bytes, 8);
+      if (key == 0)
+      {
+        encodeOpeningBookEntry(&entries[i], bytes);
+        (*hands_count)++;
+        break;
+      }
+      if (key == entries[i].key_)
+      {
+        break;
+      }
+    }
+  }
+  writeLittleEndian(data + 12, (uint64_t)*hands_count, 4);
+  FILE *file = fopen(book_file, "wb");
+  if (file == NULL)
+  {
+    free(data);
+    return CANNOT_OPEN_FILE;
+  }
+  size_t written = fwrite(data, 1, size, file);
+  free(data);
+  if (fclose(file) != 0 || written != size)
+  {
+    return CANNOT_OPEN_FILE;
+  }
+  return 0;
 }
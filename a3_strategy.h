@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------------
+// a3_strategy.h
+//
+// The interface between the game and strategy plugins. A plugin is a shared
+// object that exports a function named getStrategyPlugin, which returns a
+// StrategyPlugin. The game loads it with --plugin <file> and then offers it
+// like a built-in strategy under its name. The callbacks of a plugin receive a
+// read-only view of the game and answer with the value of a card, so no
+// command is formatted or parsed. They are called from several threads at
+// once, so they must not keep any state outside of the random state they are
+// given.
+//
+// Group: Matthias_Bergman
+//
+// Author: 12320035
+//------------------------------------------------------------------------------
+//
+
+#ifndef A3_STRATEGY_H
+#define A3_STRATEGY_H
+
+#include <stdint.h>
+
+#define STRATEGY_PLUGIN_API_VERSION 1
+#define STRATEGY_PLUGIN_ENTRY "getStrategyPlugin"
+#define STRATEGY_ROWS_COUNT 3
+
+// A card as a plugin sees it, the color is one of the characters r, g, b and w
+struct _StrategyCard_
+{
+  int value_;
+  char color_;
+};
+typedef struct _StrategyCard_ StrategyCard;
+
+// A list of cards in the order of the game, rows are sorted from the lowest to the highest value
+struct _StrategyCardList_
+{
+  const StrategyCard *cards_;
+  int count_;
+};
+typedef struct _StrategyCardList_ StrategyCardList;
+
+// Everything a player can see when it has to decide: its own cards and the rows of its opponent
+struct _StrategyView_
+{
+  int player_id_;
+  StrategyCardList handcards_;
+  StrategyCardList chosencards_;
+  StrategyCardList cardrows_[STRATEGY_ROWS_COUNT];
+  StrategyCardList opponent_cardrows_[STRATEGY_ROWS_COUNT];
+};
+typedef struct _StrategyView_ StrategyView;
+
+// chooseCard_ returns the value of the hand card to keep. chooseAction_ returns the value of a chosen card and sets
+// row_number to the index of the row to place it on, or to -1 to discard it. A value that is not one of the cards
+// falls back to the first card, and a card that does not fit the row is discarded.
+struct _StrategyPlugin_
+{
+  int api_version_;
+  const char *name_;
+  int (*chooseCard_)(const StrategyView *view, uint64_t *random_state);
+  int (*chooseAction_)(const StrategyView *view, int *row_number, uint64_t *random_state);
+};
+typedef struct _StrategyPlugin_ StrategyPlugin;
+
+typedef const StrategyPlugin *(*StrategyPluginEntry)(void);
+
+#endif
@@ -0,0 +1,513 @@
+//------------------------------------------------------------------------------
+// bench.c
+//
+// Microbenchmarks for the card list primitives of the game. Every benchmark is
+// run on synthetic decks from 20 up to 100000 cards and reports the time and
+// the number of heap allocations per operation as CSV, so that the results of
+// two versions can be compared with diff or a spreadsheet.
+//
+// Group: Matthias_Bergman
+//
+// Author: 12320035
+//------------------------------------------------------------------------------
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+
+size_t allocations_count = 0;
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// These functions count the heap allocations of the game code, they replace malloc, calloc and realloc in a3.c.
+//
+void *countedMalloc(size_t size)
+{
+  allocations_count++;
+  return malloc(size);
+}
+
+void *countedCalloc(size_t count, size_t size)
+{
+  allocations_count++;
+  return calloc(count, size);
+}
+
+void *countedRealloc(void *pointer, size_t size)
+{
+  allocations_count++;
+  return realloc(pointer, size);
+}
+
+#define malloc(size) countedMalloc(size)
+#define calloc(count, size) countedCalloc(count, size)
+#define realloc(pointer, size) countedRealloc(pointer, size)
+#define A3_NO_MAIN
+#include "../a3.c"
+#undef malloc
+#undef calloc
+#undef realloc
+
+#define BENCH_SEED 12320035
+#define BENCH_MIN_TIME_NS 200000000LL
+#define BENCH_DEFAULT_BUDGET_MS 2000
+#define BENCH_MAX_REPETITIONS 100000
+#define BENCH_LABEL_LENGTH 16
+#define BUDGET_OPTION "--budget-ms"
+
+const int BENCH_DECK_SIZES[] = {20, 100, 1000, 10000, 100000};
+const int BENCH_DECK_SIZES_COUNT = sizeof(BENCH_DECK_SIZES) / sizeof(BENCH_DECK_SIZES[0]);
+const char BENCH_COLORS[] = {'r', 'g', 'b', 'w'};
+
+// A synthetic deck, the cards have the distinct values 0 to size - 1 in a shuffled order
+struct _BenchDeck_
+{
+  int size_;
+  int *values_;
+  char (*labels_)[BENCH_LABEL_LENGTH];
+  CardArena arena_;
+  Card **cards_;
+  Card **sorted_cards_;
+};
+typedef struct _BenchDeck_ BenchDeck;
+
+// A benchmark prepares its state without being measured and then runs the measured operations on it
+struct _Benchmark_
+{
+  const char *name_;
+  void (*prepare_)(BenchDeck *deck, Player *player);
+  long long (*run_)(BenchDeck *deck, Player *player);
+};
+typedef struct _Benchmark_ Benchmark;
+
+int createDeck(BenchDeck *deck, int size);
+void freeDeck(BenchDeck *deck);
+void runBenchmark(const Benchmark *benchmark, BenchDeck *deck, long long budget_ns, long long *last_run_ns,
+                  FILE *results);
+long long getTimeNs(void);
+void linkCards(Card **cards, int count, Card **head);
+void prepareCreateCard(BenchDeck *deck, Player *player);
+long long runCreateCard(BenchDeck *deck, Player *player);
+void prepareEmptyPlayer(BenchDeck *deck, Player *player);
+long long runDealCard(BenchDeck *deck, Player *player);
+long long runAddCardToChosen(BenchDeck *deck, Player *player);
+void prepareFullHand(BenchDeck *deck, Player *player);
+long long runRemoveCardFromHand(BenchDeck *deck, Player *player);
+long long runAddCardToRow(BenchDeck *deck, Player *player);
+void prepareUnsortedHand(BenchDeck *deck, Player *player);
+long long runSortCards(BenchDeck *deck, Player *player);
+void prepareFullPlayer(BenchDeck *deck, Player *player);
+long long runCalculatePlayerPoints(BenchDeck *deck, Player *player);
+long long runPrintPlayer(BenchDeck *deck, Player *player);
+void prepareBoardBatch(BenchDeck *deck, Player *player);
+long long runScoreBoardBatch(BenchDeck *deck, Player *player);
+
+const Benchmark BENCHMARKS[] = {
+  {"createCard", prepareCreateCard, runCreateCard},
+  {"dealCard", prepareEmptyPlayer, runDealCard},
+  {"addCardToChosen", prepareEmptyPlayer, runAddCardToChosen},
+  {"removeCardFromHand", prepareFullHand, runRemoveCardFromHand},
+  {"addCardToRow", prepareEmptyPlayer, runAddCardToRow},
+  {"sortCards", prepareUnsortedHand, runSortCards},
+  {"calculatePlayerPoints", prepareFullPlayer, runCalculatePlayerPoints},
+  {"printPlayer", prepareFullPlayer, runPrintPlayer},
+  {"scoreBoardBatch", prepareBoardBatch, runScoreBoardBatch},
+};
+const int BENCHMARKS_COUNT = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+
+// Keeps the results of the measured operations alive, so that the compiler cannot remove them
+volatile int bench_sink = 0;
+
+// The boards that are scored at once, one board for every card of the deck
+BoardBatch bench_boards = {{NULL}, {NULL}, NULL, 0, 0};
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This is the main function of the benchmark. It runs every benchmark on every deck size and prints one CSV line per
+/// run. A deck size is skipped if the previous size, scaled quadratically, would take longer than the time budget of
+/// a single run, which can be set with --budget-ms <milliseconds>. Everything the game prints while it is measured
+/// goes to /dev/null, only the CSV lines are written to the original stdout.
+///
+/// @param argc The number of arguments
+/// @param argv The arguments
+///
+/// @return
+///      0 if the benchmarks were run
+///      1 if the arguments are invalid
+///      4 if there was a memory allocation error
+//
+int main(int argc, char *argv[])
+{
+  long long budget_ms = BENCH_DEFAULT_BUDGET_MS;
+  if (argc == 3 && strcmp(argv[1], BUDGET_OPTION) == 0 && stringToInt(argv[2]) > 0)
+  {
+    budget_ms = stringToInt(argv[2]);
+  }
+  else if (argc != 1)
+  {
+    printf("Usage: %s [%s <milliseconds>]\n", argv[0], BUDGET_OPTION);
+    return 1;
+  }
+  FILE *results = fdopen(dup(STDOUT_FILENO), "w");
+  if (results == NULL || freopen("/dev/null", "w", stdout) == NULL)
+  {
+    printf("Error: Cannot redirect the output of the game\n");
+    return 1;
+  }
+  fprintf(results, "benchmark,cards,repetitions,ns_per_op,allocs_per_op,status\n");
+  for (int i = 0; i < BENCHMARKS_COUNT; i++)
+  {
+    long long last_run_ns = 0;
+    int last_size = 0;
+    for (int j = 0; j < BENCH_DECK_SIZES_COUNT; j++)
+    {
+      int size = BENCH_DECK_SIZES[j];
+      double scale = (double)size / (last_size > 0 ? last_size : size);
+      if (last_run_ns * scale * scale > budget_ms * 1000000.0)
+      {
+        fprintf(results, "%s,%i,0,0,0,skipped\n", BENCHMARKS[i].name_, size);
+        continue;
+      }
+      BenchDeck deck;
+      if (createDeck(&deck, size) != 0)
+      {
+        fprintf(results, MEMORY_ALLOCATION_ERROR_MESSAGE);
+        fclose(results);
+        return MEMORY_ALLOCATION_ERROR;
+      }
+      runBenchmark(&BENCHMARKS[i], &deck, budget_ms * 1000000LL, &last_run_ns, results);
+      freeDeck(&deck);
+      last_size = size;
+      fflush(results);
+    }
+  }
+  freeOutputBuffer(&status_output);
+  freeBoardBatch(&bench_boards);
+  fclose(results);
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function runs a benchmark on a deck until it was measured for a minimum time and prints its result. Every
+/// repetition is prepared anew, only the operations themselves are measured.
+///
+/// @param benchmark The benchmark to run
+/// @param deck The deck to run the benchmark on
+/// @param budget_ns The time after which no further repetitions are started
+/// @param last_run_ns Is set to the time a single repetition took
+/// @param results The stream the result is printed to
+///
+/// @return void
+//
+void runBenchmark(const Benchmark *benchmark, BenchDeck *deck, long long budget_ns, long long *last_run_ns,
+                  FILE *results)
+{
+  long long total_ns = 0;
+  long long total_ops = 0;
+  size_t total_allocations = 0;
+  int repetitions = 0;
+  Player player;
+  do
+  {
+    benchmark->prepare_(deck, &player);
+    size_t allocations_before = allocations_count;
+    long long start = getTimeNs();
+    long long ops = benchmark->run_(deck, &player);
+    long long elapsed = getTimeNs() - start;
+    total_allocations += allocations_count - allocations_before;
+    total_ns += elapsed;
+    total_ops += ops;
+    *last_run_ns = elapsed;
+    repetitions++;
+  } while (total_ns < BENCH_MIN_TIME_NS && total_ns < budget_ns && repetitions < BENCH_MAX_REPETITIONS);
+  fprintf(results, "%s,%i,%i,%.2f,%.4f,ok\n", benchmark->name_, deck->size_, repetitions, (double)total_ns / total_ops,
+          (double)total_allocations / total_ops);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function creates a synthetic deck. The values are shuffled with a fixed seed, so every run and every version
+/// of the game is measured with the same decks.
+///
+/// @param deck The deck to create
+/// @param size The number of cards
+///
+/// @return
+///      0 if the deck was created
+///      4 if there was a memory allocation error
+//
+int createDeck(BenchDeck *deck, int size)
+{
+  deck->size_ = size;
+  deck->values_ = malloc(sizeof(int) * size);
+  deck->labels_ = malloc(sizeof(*deck->labels_) * size);
+  deck->cards_ = malloc(sizeof(Card *) * size);
+  deck->sorted_cards_ = malloc(sizeof(Card *) * size);
+  if (initCardArena(&deck->arena_, size) != 0 || deck->values_ == NULL || deck->labels_ == NULL ||
+      deck->cards_ == NULL || deck->sorted_cards_ == NULL)
+  {
+    freeDeck(deck);
+    return MEMORY_ALLOCATION_ERROR;
+  }
+  uint64_t random_state = BENCH_SEED;
+  for (int i = 0; i < size; i++)
+  {
+    deck->values_[i] = i;
+  }
+  for (int i = size - 1; i > 0; i--)
+  {
+    int j = randomBelow(&random_state, i + 1);
+    int temp = deck->values_[i];
+    deck->values_[i] = deck->values_[j];
+    deck->values_[j] = temp;
+  }
+  char line[BENCH_LABEL_LENGTH];
+  for (int i = 0; i < size; i++)
+  {
+    snprintf(deck->labels_[i], BENCH_LABEL_LENGTH, "%i_%c\n", deck->values_[i], BENCH_COLORS[i % 4]);
+    memcpy(line, deck->labels_[i], BENCH_LABEL_LENGTH);
+    createCard(&deck->arena_, line, &deck->cards_[i]);
+    deck->sorted_cards_[deck->values_[i]] = deck->cards_[i];
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function frees a synthetic deck together with its cards.
+///
+/// @param deck The deck to free
+///
+/// @return void
+//
+void freeDeck(BenchDeck *deck)
+{
+  free(deck->values_);
+  free(deck->labels_);
+  free(deck->cards_);
+  free(deck->sorted_cards_);
+  freeCardArena(&deck->arena_);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns the current time of a monotonic clock in nanoseconds.
+///
+/// @return
+///      the current time in nanoseconds
+//
+long long getTimeNs(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function links cards into a list in the given order, without using the list functions of the game.
+///
+/// @param cards The cards to link
+/// @param count The number of cards
+/// @param head Is set to the head of the list
+///
+/// @return void
+//
+void linkCards(Card **cards, int count, Card **head)
+{
+  *head = NULL;
+  for (int i = count - 1; i >= 0; i--)
+  {
+    cards[i]->next_ = *head;
+    *head = cards[i];
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Creating cards needs an empty arena.
+//
+void prepareCreateCard(BenchDeck *deck, Player *player)
+{
+  resetCardArena(&deck->arena_);
+  initPlayer(player, 1);
+}
+
+long long runCreateCard(BenchDeck *deck, Player *player)
+{
+  (void)player;
+  char line[BENCH_LABEL_LENGTH];
+  for (int i = 0; i < deck->size_; i++)
+  {
+    // createCard splits the line in place, so it gets a fresh copy every time
+    memcpy(line, deck->labels_[i], BENCH_LABEL_LENGTH);
+    Card *card = NULL;
+    createCard(&deck->arena_, line, &card);
+  }
+  bench_sink = deck->arena_.used_;
+  return deck->size_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Adding cards to the hand, the chosen cards or a row starts with a player without cards.
+//
+void prepareEmptyPlayer(BenchDeck *deck, Player *player)
+{
+  (void)deck;
+  initPlayer(player, 1);
+}
+
+long long runDealCard(BenchDeck *deck, Player *player)
+{
+  Card *last_card = NULL;
+  for (int i = 0; i < deck->size_; i++)
+  {
+    dealCard(player, &last_card, deck->cards_[i]);
+  }
+  bench_sink = player->handcards_->value_;
+  return deck->size_;
+}
+
+long long runAddCardToChosen(BenchDeck *deck, Player *player)
+{
+  for (int i = 0; i < deck->size_; i++)
+  {
+    addCardToChosen(player, deck->cards_[i]);
+  }
+  bench_sink = player->chosencards_->value_;
+  return deck->size_;
+}
+
+// The cards are added in ascending order, so that every card extends the end of the row
+long long runAddCardToRow(BenchDeck *deck, Player *player)
+{
+  for (int i = 0; i < deck->size_; i++)
+  {
+    addCardToRow(player, deck->sorted_cards_[i], 0);
+  }
+  bench_sink = player->cardrows_[0].length_;
+  return deck->size_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Removing cards starts with all cards of the deck in the hand in shuffled order, they are removed in ascending order.
+//
+void prepareFullHand(BenchDeck *deck, Player *player)
+{
+  initPlayer(player, 1);
+  linkCards(deck->cards_, deck->size_, &player->handcards_);
+  for (int i = 0; i < deck->size_; i++)
+  {
+    indexHandCard(player, deck->cards_[i]);
+  }
+}
+
+long long runRemoveCardFromHand(BenchDeck *deck, Player *player)
+{
+  for (int i = 0; i < deck->size_; i++)
+  {
+    removeCardFromHand(player, deck->sorted_cards_[i]);
+  }
+  bench_sink = player->handcards_ == NULL;
+  return deck->size_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Sorting starts with all cards of the deck in the hand in shuffled order. A single sort of the whole hand is one
+/// operation.
+//
+void prepareUnsortedHand(BenchDeck *deck, Player *player)
+{
+  initPlayer(player, 1);
+  linkCards(deck->cards_, deck->size_, &player->handcards_);
+}
+
+long long runSortCards(BenchDeck *deck, Player *player)
+{
+  (void)deck;
+  sortCards(&player->handcards_);
+  bench_sink = player->handcards_->value_;
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Scoring and printing start with a player whose cards are spread over the hand, the chosen cards and the rows. A
+/// single call is one operation.
+//
+void prepareFullPlayer(BenchDeck *deck, Player *player)
+{
+  initPlayer(player, 1);
+  int quarter = deck->size_ / 4;
+  linkCards(deck->sorted_cards_, quarter, &player->handcards_);
+  linkCards(deck->sorted_cards_ + quarter, quarter, &player->chosencards_);
+  // Cards in descending order always extend the front of a row, which keeps preparing the rows linear
+  for (int value = deck->size_ - 1; value >= 2 * quarter; value--)
+  {
+    addCardToRow(player, deck->sorted_cards_[value], value % MAX_CARD_ROWS);
+  }
+}
+
+long long runCalculatePlayerPoints(BenchDeck *deck, Player *player)
+{
+  (void)deck;
+  long long ops = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    bench_sink = calculatePlayerPoints(player->cardrows_);
+    ops++;
+  }
+  return ops;
+}
+
+long long runPrintPlayer(BenchDeck *deck, Player *player)
+{
+  (void)deck;
+  printPlayer(player);
+  fflush(stdout);
+  return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Batch scoring starts with one finished board for every card of the deck, the row lengths and points are taken from
+/// the shuffled values. Scoring the whole batch is one operation per board.
+//
+void prepareBoardBatch(BenchDeck *deck, Player *player)
+{
+  (void)player;
+  if (bench_boards.capacity_ < deck->size_)
+  {
+    freeBoardBatch(&bench_boards);
+    if (initBoardBatch(&bench_boards, deck->size_) != 0)
+    {
+      return;
+    }
+  }
+  bench_boards.count_ = 0;
+  CardRow rows[MAX_CARD_ROWS];
+  memset(rows, 0, sizeof(rows));
+  for (int i = 0; i < deck->size_; i++)
+  {
+    for (int j = 0; j < MAX_CARD_ROWS; j++)
+    {
+      rows[j].length_ = deck->values_[(i + j) % deck->size_] % 8;
+      rows[j].points_ = rows[j].length_ * CARD_COLOR_POINTS[(unsigned char)BENCH_COLORS[(i + j) % 4]];
+    }
+    addBoardToBatch(&bench_boards, rows);
+  }
+}
+
+long long runScoreBoardBatch(BenchDeck *deck, Player *player)
+{
+  (void)deck;
+  (void)player;
+  scoreBoardBatch(&bench_boards);
+  bench_sink = bench_boards.count_ > 0 ? bench_boards.points_[bench_boards.count_ - 1] : 0;
+  return bench_boards.count_ > 0 ? bench_boards.count_ : 1;
+}
@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+// solvecheck.c
+//
+// Timing check for the solve mode. The game solves every full deck of the
+// reference configs as a separate process whose CPU time is limited, so a
+// solver that lost its pruning is killed instead of searching for hours. A
+// deck passes if the game quits with 0 within the limit. The results are
+// printed as CSV, the return value is 1 if any deck failed. The optimal play
+// itself is checked by the test cases.
+//
+// Group: Matthias_Bergman
+//
+// Author: 12320035
+//------------------------------------------------------------------------------
+//
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define TRUE 1
+#define FALSE 0
+
+#define SOLVE_CHECK_DEFAULT_BINARY "./a3"
+#define BINARY_OPTION "--binary"
+#define SOLVE_OPTION "--solve"
+#define QUIET_OPTION "--quiet"
+// A full deck of 20 cards takes a few seconds without optimizations, a search without pruning takes hours
+#define SOLVE_CHECK_MAX_CPU_SECONDS 10
+
+// The reference configs hold three different decks, every one of them is solved
+const char *const SOLVE_CHECK_CONFIG_FILES[] = {"configs_reference/config_01.txt", "configs_reference/config_03.txt",
+                                                "configs_reference/config_11.txt"};
+const int SOLVE_CHECK_CONFIG_FILES_COUNT = sizeof(SOLVE_CHECK_CONFIG_FILES) / sizeof(SOLVE_CHECK_CONFIG_FILES[0]);
+
+// The outcome of a single run of the game
+struct _RunResult_
+{
+  int exit_code_;
+  int signal_;
+  long long cpu_ns_;
+  long peak_kb_;
+};
+typedef struct _RunResult_ RunResult;
+
+int runSolve(const char *binary, const char *config_file, RunResult *result);
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This is the main function of the solver check. It solves every deck and prints its CPU time and peak memory.
+///
+/// @param argc The number of arguments
+/// @param argv The arguments
+///
+/// @return
+///      0 if all decks were solved within the limit
+///      1 if a deck failed or the arguments are invalid
+//
+int main(int argc, char *argv[])
+{
+  const char *binary = SOLVE_CHECK_DEFAULT_BINARY;
+  if (argc == 3 && strcmp(argv[1], BINARY_OPTION) == 0)
+  {
+    binary = argv[2];
+  }
+  else if (argc != 1)
+  {
+    printf("Usage: %s [%s <game binary>]\n", argv[0], BINARY_OPTION);
+    return 1;
+  }
+  int failed = FALSE;
+  printf("config,cpu_ms,peak_kb,status\n");
+  for (int i = 0; i < SOLVE_CHECK_CONFIG_FILES_COUNT; i++)
+  {
+    RunResult result;
+    if (runSolve(binary, SOLVE_CHECK_CONFIG_FILES[i], &result) != 0)
+    {
+      printf("Error: Cannot run %s\n", binary);
+      return 1;
+    }
+    int passed = result.exit_code_ == 0 && result.signal_ == 0;
+    printf("%s,%.1f,%li,%s\n", SOLVE_CHECK_CONFIG_FILES[i], result.cpu_ns_ / 1000000.0, result.peak_kb_,
+           passed ? "ok" : "failed");
+    fflush(stdout);
+    failed = failed || !passed;
+  }
+  return failed ? 1 : 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function lets the game solve a config in a child process whose output is discarded. The CPU time of the child
+/// is limited, so a solver that runs away is killed by the kernel.
+///
+/// @param binary The path of the game
+/// @param config_file The config file to solve
+/// @param result Output parameter for the outcome of the run
+///
+/// @return
+///      0 if the game was run
+///      1 if the child process could not be created
+//
+int runSolve(const char *binary, const char *config_file, RunResult *result)
+{
+  pid_t child = fork();
+  if (child < 0)
+  {
+    return 1;
+  }
+  if (child == 0)
+  {
+    int output = open("/dev/null", O_RDWR);
+    struct rlimit cpu_limit = {SOLVE_CHECK_MAX_CPU_SECONDS, SOLVE_CHECK_MAX_CPU_SECONDS};
+    if (output < 0 || dup2(output, STDIN_FILENO) < 0 || dup2(output, STDOUT_FILENO) < 0 ||
+        setrlimit(RLIMIT_CPU, &cpu_limit) != 0)
+    {
+      _exit(127);
+    }
+    execl(binary, binary, SOLVE_OPTION, QUIET_OPTION, config_file, (char *)NULL);
+    _exit(127);
+  }
+  int status = 0;
+  struct rusage usage;
+  if (wait4(child, &status, 0, &usage) != child)
+  {
+    return 1;
+  }
+  result->cpu_ns_ = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000LL +
+                    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000LL;
+  result->exit_code_ = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  result->signal_ = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+  result->peak_kb_ = usage.ru_maxrss;
+  return 0;
+}
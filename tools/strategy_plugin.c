@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------
+// strategy_plugin.c
+//
+// An example strategy plugin. It keeps the hand card with the most valuable
+// color and places every chosen card on the row it extends with the smallest
+// gap, cards that fit no row are discarded. Build it with make plugin and load
+// it with --plugin ./strategy_plugin.so --strategy colors.
+//
+// Group: Matthias_Bergman
+//
+// Author: 12320035
+//------------------------------------------------------------------------------
+//
+
+#include <stddef.h>
+
+#include "../a3_strategy.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function returns the points a card of the given color is worth.
+///
+/// @param color The color of the card
+///
+/// @return
+///      the points of the color
+//
+static int getColorPoints(char color)
+{
+  switch (color)
+  {
+    case 'r':
+      return 10;
+    case 'w':
+      return 7;
+    case 'g':
+      return 4;
+    case 'b':
+      return 3;
+    default:
+      return 0;
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function keeps the hand card with the most valuable color, the higher value wins a tie.
+///
+/// @param view The view of the game
+/// @param random_state The state of the random number generator, it is not used
+///
+/// @return
+///      the value of the card to keep
+//
+static int chooseColorsCard(const StrategyView *view, uint64_t *random_state)
+{
+  (void)random_state;
+  const StrategyCardList *hand = &view->handcards_;
+  int best = 0;
+  for (int i = 1; i < hand->count_; i++)
+  {
+    int points = getColorPoints(hand->cards_[i].color_);
+    int best_points = getColorPoints(hand->cards_[best].color_);
+    if (points > best_points || (points == best_points && hand->cards_[i].value_ > hand->cards_[best].value_))
+    {
+      best = i;
+    }
+  }
+  return hand->count_ > 0 ? hand->cards_[best].value_ : 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function places the first chosen card on the row it extends with the smallest gap, or discards it.
+///
+/// @param view The view of the game
+/// @param row_number Output parameter for the index of the row, -1 to discard the card
+/// @param random_state The state of the random number generator, it is not used
+///
+/// @return
+///      the value of the card to place or discard
+//
+static int chooseColorsAction(const StrategyView *view, int *row_number, uint64_t *random_state)
+{
+  (void)random_state;
+  if (view->chosencards_.count_ == 0)
+  {
+    return 0;
+  }
+  int value = view->chosencards_.cards_[0].value_;
+  int best_gap = -1;
+  *row_number = -1;
+  for (int i = 0; i < STRATEGY_ROWS_COUNT; i++)
+  {
+    const StrategyCardList *row = &view->cardrows_[i];
+    int gap = 0;
+    if (row->count_ == 0)
+    {
+      gap = 120;
+    }
+    else if (value < row->cards_[0].value_)
+    {
+      gap = row->cards_[0].value_ - value;
+    }
+    else if (value > row->cards_[row->count_ - 1].value_)
+    {
+      gap = value - row->cards_[row->count_ - 1].value_;
+    }
+    else
+    {
+      continue;
+    }
+    if (best_gap < 0 || gap < best_gap)
+    {
+      best_gap = gap;
+      *row_number = i;
+    }
+  }
+  return value;
+}
+
+static const StrategyPlugin COLORS_PLUGIN = {STRATEGY_PLUGIN_API_VERSION, "colors", chooseColorsCard,
+                                             chooseColorsAction};
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This is the entry point the game looks up after loading the plugin.
+///
+/// @return
+///      the plugin
+//
+const StrategyPlugin *getStrategyPlugin(void)
+{
+  return &COLORS_PLUGIN;
+}
@@ -0,0 +1,392 @@
+//------------------------------------------------------------------------------
+// stress.c
+//
+// Stress tests for hostile console input. Every scenario feeds one kind of
+// pathological input of 1, 4 and 16 MiB to the choosing prompt or the action
+// prompt of the game and quits afterwards. The game runs as a separate
+// process, so a crash or a runaway loop cannot take the suite down with it.
+// A scenario passes if the game quits with 0 and its time and peak memory
+// grow at most linearly with the size of the input. The results are printed
+// as CSV, the return value is 1 if any scenario failed.
+//
+// Group: Matthias_Bergman
+//
+// Author: 12320035
+//------------------------------------------------------------------------------
+//
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRUE 1
+#define FALSE 0
+
+#define STRESS_CONFIG_FILE "configs_reference/config_06.txt"
+#define STRESS_DEFAULT_BINARY "./a3"
+#define BINARY_OPTION "--binary"
+#define STRESS_MIB (1024L * 1024L)
+// A run may take this many times longer per byte of input than the smallest run of the same scenario
+#define STRESS_TIME_SLOPE 4.0
+// Runs that take less than this per byte of input are accepted without comparing them, so timer noise is ignored
+#define STRESS_MIN_NS_PER_BYTE 20.0
+// The game is killed once it used this much CPU time per byte of input, a quadratic loop would run for hours
+#define STRESS_MAX_NS_PER_BYTE 1000.0
+// The peak memory may exceed the peak memory without hostile input by this many bytes per byte of input
+#define STRESS_MEMORY_SLOPE 4.0
+#define STRESS_MEMORY_SLACK_KB 1024L
+#define STRESS_MAX_ADDRESS_SPACE (2048L * STRESS_MIB)
+
+const long STRESS_SIZES[] = {1 * STRESS_MIB, 4 * STRESS_MIB, 16 * STRESS_MIB};
+const int STRESS_SIZES_COUNT = sizeof(STRESS_SIZES) / sizeof(STRESS_SIZES[0]);
+
+// The cards that are kept in the first round of config_06, after them player 1 is asked for an action
+#define STRESS_ACTION_PREFIX "28\n38\n30\n33\n"
+#define STRESS_QUIT "quit\n"
+
+// The commands of a flood, none of them is valid at either prompt
+const char *const STRESS_INVALID_COMMANDS[] = {"help me\n", "place 4\n", "discard\n", "place 1 999999\n", "-7\n",
+                                               "\n", "999999999999\n", "   \n", "place x y z\n", "42\n"};
+const int STRESS_INVALID_COMMANDS_COUNT = sizeof(STRESS_INVALID_COMMANDS) / sizeof(STRESS_INVALID_COMMANDS[0]);
+
+// A scenario writes its hostile input of the given size to a file, after the prefix that leads to its prompt
+struct _Scenario_
+{
+  const char *name_;
+  const char *prefix_;
+  void (*write_)(FILE *input, long size);
+};
+typedef struct _Scenario_ Scenario;
+
+// The outcome of a single run of the game
+struct _RunResult_
+{
+  int exit_code_;
+  int signal_;
+  long long time_ns_;
+  long peak_kb_;
+};
+typedef struct _RunResult_ RunResult;
+
+void writeLongLine(FILE *input, long size);
+void writeWhitespace(FILE *input, long size);
+void writeLongNumber(FILE *input, long size);
+void writeInvalidFlood(FILE *input, long size);
+void writeNothing(FILE *input, long size);
+void writePattern(FILE *input, const char *pattern, long size);
+int runScenario(const char *binary, const Scenario *scenario, long size, RunResult *result);
+int createInput(const Scenario *scenario, long size, char *path);
+int runGame(const char *binary, const char *input_path, long long max_cpu_ns, RunResult *result);
+long long getTimeNs(void);
+int checkRun(const RunResult *result, const RunResult *baseline, const RunResult *first, long first_size, long size);
+
+const Scenario SCENARIOS[] = {
+  {"choosing_long_line", "", writeLongLine},
+  {"choosing_whitespace", "", writeWhitespace},
+  {"choosing_long_number", "", writeLongNumber},
+  {"choosing_invalid_flood", "", writeInvalidFlood},
+  {"action_long_line", STRESS_ACTION_PREFIX, writeLongLine},
+  {"action_whitespace", STRESS_ACTION_PREFIX, writeWhitespace},
+  {"action_long_number", STRESS_ACTION_PREFIX, writeLongNumber},
+  {"action_invalid_flood", STRESS_ACTION_PREFIX, writeInvalidFlood},
+};
+const int SCENARIOS_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+// The game without hostile input, its time and memory are subtracted from every run
+const Scenario BASELINE_SCENARIO = {"baseline", STRESS_ACTION_PREFIX, writeNothing};
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This is the main function of the stress tests. It measures the game without hostile input first and then runs
+/// every scenario with every input size. A scenario is not run with larger inputs once it failed.
+///
+/// @param argc The number of arguments
+/// @param argv The arguments
+///
+/// @return
+///      0 if all scenarios passed
+///      1 if a scenario failed or the arguments are invalid
+//
+int main(int argc, char *argv[])
+{
+  const char *binary = STRESS_DEFAULT_BINARY;
+  if (argc == 3 && strcmp(argv[1], BINARY_OPTION) == 0)
+  {
+    binary = argv[2];
+  }
+  else if (argc != 1)
+  {
+    printf("Usage: %s [%s <game binary>]\n", argv[0], BINARY_OPTION);
+    return 1;
+  }
+  RunResult baseline;
+  if (runScenario(binary, &BASELINE_SCENARIO, 0, &baseline) != 0 || baseline.exit_code_ != 0)
+  {
+    printf("Error: Cannot run %s with %s\n", binary, STRESS_CONFIG_FILE);
+    return 1;
+  }
+  int failed = FALSE;
+  printf("scenario,bytes,time_ms,peak_kb,status\n");
+  for (int i = 0; i < SCENARIOS_COUNT; i++)
+  {
+    RunResult first;
+    for (int j = 0; j < STRESS_SIZES_COUNT; j++)
+    {
+      RunResult result;
+      if (runScenario(binary, &SCENARIOS[i], STRESS_SIZES[j], &result) != 0)
+      {
+        printf("Error: Cannot create the input of %s\n", SCENARIOS[i].name_);
+        return 1;
+      }
+      if (j == 0)
+      {
+        first = result;
+      }
+      int passed = checkRun(&result, &baseline, &first, STRESS_SIZES[0], STRESS_SIZES[j]);
+      printf("%s,%li,%.1f,%li,%s\n", SCENARIOS[i].name_, STRESS_SIZES[j], result.time_ns_ / 1000000.0,
+             result.peak_kb_, passed ? "ok" : "failed");
+      fflush(stdout);
+      if (!passed)
+      {
+        failed = TRUE;
+        break;
+      }
+    }
+  }
+  return failed ? 1 : 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function runs the game once with the input of a scenario. The input is written to a temporary file first, so
+/// writing it is not measured.
+///
+/// @param binary The path of the game
+/// @param scenario The scenario to run
+/// @param size The size of the hostile input in bytes
+/// @param result Output parameter for the outcome of the run
+///
+/// @return
+///      0 if the game was run
+///      1 if the input or the process could not be created
+//
+int runScenario(const char *binary, const Scenario *scenario, long size, RunResult *result)
+{
+  char input_path[] = "/tmp/a3_stress_XXXXXX";
+  if (createInput(scenario, size, input_path) != 0)
+  {
+    return 1;
+  }
+  long long max_cpu_ns = (long long)(STRESS_MAX_NS_PER_BYTE * size) + 1000000000LL;
+  int error = runGame(binary, input_path, max_cpu_ns, result);
+  unlink(input_path);
+  return error;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function writes the input of a scenario to a new temporary file: the prefix that leads to the prompt, the
+/// hostile input and a quit command.
+///
+/// @param scenario The scenario whose input is written
+/// @param size The size of the hostile input in bytes
+/// @param path The template of the file name, it is replaced by the name of the file
+///
+/// @return
+///      0 if the file was written
+///      1 if the file could not be written
+//
+int createInput(const Scenario *scenario, long size, char *path)
+{
+  int file_descriptor = mkstemp(path);
+  if (file_descriptor < 0)
+  {
+    return 1;
+  }
+  FILE *input = fdopen(file_descriptor, "w");
+  if (input == NULL)
+  {
+    close(file_descriptor);
+    unlink(path);
+    return 1;
+  }
+  fputs(scenario->prefix_, input);
+  scenario->write_(input, size);
+  fputs(STRESS_QUIT, input);
+  if (ferror(input) | fclose(input))
+  {
+    unlink(path);
+    return 1;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function runs the game in a child process that reads the given file and whose output is discarded. The CPU
+/// time and the address space of the child are limited, so a runaway game is killed instead of hanging the suite.
+///
+/// @param binary The path of the game
+/// @param input_path The file the game reads its input from
+/// @param max_cpu_ns The CPU time after which the game is killed
+/// @param result Output parameter for the outcome of the run
+///
+/// @return
+///      0 if the game was run
+///      1 if the child process could not be created
+//
+int runGame(const char *binary, const char *input_path, long long max_cpu_ns, RunResult *result)
+{
+  long long start = getTimeNs();
+  pid_t child = fork();
+  if (child < 0)
+  {
+    return 1;
+  }
+  if (child == 0)
+  {
+    int input = open(input_path, O_RDONLY);
+    int output = open("/dev/null", O_WRONLY);
+    struct rlimit cpu_limit = {(rlim_t)(max_cpu_ns / 1000000000LL), (rlim_t)(max_cpu_ns / 1000000000LL)};
+    struct rlimit memory_limit = {STRESS_MAX_ADDRESS_SPACE, STRESS_MAX_ADDRESS_SPACE};
+    if (input < 0 || output < 0 || dup2(input, STDIN_FILENO) < 0 || dup2(output, STDOUT_FILENO) < 0 ||
+        dup2(output, STDERR_FILENO) < 0 || setrlimit(RLIMIT_CPU, &cpu_limit) != 0 ||
+        setrlimit(RLIMIT_AS, &memory_limit) != 0)
+    {
+      _exit(127);
+    }
+    execl(binary, binary, STRESS_CONFIG_FILE, (char *)NULL);
+    _exit(127);
+  }
+  int status = 0;
+  struct rusage usage;
+  if (wait4(child, &status, 0, &usage) != child)
+  {
+    return 1;
+  }
+  result->time_ns_ = getTimeNs() - start;
+  result->exit_code_ = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  result->signal_ = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+  result->peak_kb_ = usage.ru_maxrss;
+  return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function checks a run against the budgets. The time and memory of the baseline are subtracted, what remains
+/// is caused by the hostile input. The time per byte may only grow by a constant factor over the smallest run of the
+/// scenario, the memory per byte is bounded by a constant.
+///
+/// @param result The run to check
+/// @param baseline The run without hostile input
+/// @param first The smallest run of the same scenario
+/// @param first_size The input size of the smallest run
+/// @param size The input size of the run to check
+///
+/// @return
+///      TRUE if the run is within the budgets
+///      FALSE otherwise
+//
+int checkRun(const RunResult *result, const RunResult *baseline, const RunResult *first, long first_size, long size)
+{
+  if (result->exit_code_ != 0 || result->signal_ != 0)
+  {
+    return FALSE;
+  }
+  long long extra_ns = result->time_ns_ > baseline->time_ns_ ? result->time_ns_ - baseline->time_ns_ : 0;
+  long long first_extra_ns = first->time_ns_ > baseline->time_ns_ ? first->time_ns_ - baseline->time_ns_ : 0;
+  double ns_per_byte = (double)extra_ns / size;
+  double first_ns_per_byte = (double)first_extra_ns / first_size;
+  if (ns_per_byte > STRESS_MIN_NS_PER_BYTE && ns_per_byte > STRESS_TIME_SLOPE * first_ns_per_byte)
+  {
+    return FALSE;
+  }
+  long extra_kb = result->peak_kb_ - baseline->peak_kb_;
+  return extra_kb <= STRESS_MEMORY_SLOPE * size / 1024 + STRESS_MEMORY_SLACK_KB;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// These functions write the hostile inputs: a single line of letters, a single line of spaces and tabs, a single
+/// number with more digits than any integer, and a flood of short invalid commands.
+///
+/// @param input The file to write to
+/// @param size The number of bytes to write
+///
+/// @return void
+//
+void writeLongLine(FILE *input, long size)
+{
+  writePattern(input, "x", size - 1);
+  fputc('\n', input);
+}
+
+void writeWhitespace(FILE *input, long size)
+{
+  writePattern(input, " \t", size - 1);
+  fputc('\n', input);
+}
+
+void writeLongNumber(FILE *input, long size)
+{
+  writePattern(input, "9", size - 1);
+  fputc('\n', input);
+}
+
+void writeInvalidFlood(FILE *input, long size)
+{
+  for (long written = 0, i = 0; written < size; i++)
+  {
+    const char *command = STRESS_INVALID_COMMANDS[i % STRESS_INVALID_COMMANDS_COUNT];
+    fputs(command, input);
+    written += strlen(command);
+  }
+}
+
+void writeNothing(FILE *input, long size)
+{
+  (void)input;
+  (void)size;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// This function writes a pattern repeatedly until the given number of bytes was written, the last repetition may be
+/// cut off.
+///
+/// @param input The file to write to
+/// @param pattern The pattern to repeat
+/// @param size The number of bytes to write
+///
+/// @return void
+//
+void writePattern(FILE *input, const char *pattern, long size)
+{
+  long length = strlen(pattern);
+  for (long i = 0; i < size; i++)
+  {
+    fputc(pattern[i % length], input);
+  }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// A helper function that returns the time of a monotonic clock in nanoseconds.
+///
+/// @return
+///      the current time in nanoseconds
+//
+long long getTimeNs(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000LL + now.tv_nsec;
+}